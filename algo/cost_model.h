@@ -0,0 +1,289 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_COST_MODEL_H
+#define FLIPDISTANCE_COST_MODEL_H
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "flip_distance_bounds.h"
+#include "registry.h"
+#include "special_instances.h"
+#include "../triangulation/TriangulatedGraph.h"
+
+// Diagonals of s whose flip creates a diagonal of t.
+inline unsigned int goodFlipCount(const TriangulatedGraph &s, const TriangulatedGraph &t) {
+    TriangulatedGraph g = s;
+    unsigned int count = 0;
+    for (const Edge &e: s.getEdges()) {
+        if (t.hasEdge(e)) {
+            continue;
+        }
+        Edge created = g.flip(e);
+        count += t.hasEdge(created);
+        g.flip(created);
+    }
+    return count;
+}
+
+// Vertices of the largest kernel left by reduceToKernels, i.e. after splitting along common diagonals and
+// taking every good flip; 0 if none is left.
+inline size_t kernelSize(const TriangulatedGraph &s, const TriangulatedGraph &t) {
+    std::vector<Edge> path;
+    size_t size = 0;
+    for (const InstancePiece &kernel: reduceToKernels(InstancePiece::whole(s, t), path)) {
+        size = std::max(size, kernel.start.getSize());
+    }
+    return size;
+}
+
+// Number of sets of diagonals no two of which share a triangle, i.e. of matchings of the dual tree, which is
+// how many source sets FlipDistanceSource enumerates. Counted by dynamic programming, without enumerating.
+inline double sourceSetCount(const TriangulatedGraph &g) {
+    std::vector<std::vector<int>> triangles;
+    std::map<std::pair<int, int>, std::vector<int>> trianglesOf;
+    for (int a = 0; a < (int) g.getSize(); ++a) {
+        const std::set<int> &neighbors = g.vertices[a].neighbors;
+        for (auto b = neighbors.upper_bound(a); b != neighbors.end(); ++b) {
+            for (auto c = std::next(b); c != neighbors.end(); ++c) {
+                if (g.hasEdge(*b, *c)) {
+                    int id = (int) triangles.size();
+                    triangles.push_back({a, *b, *c});
+                    for (auto edge: {std::make_pair(a, *b), std::make_pair(a, *c), std::make_pair(*b, *c)}) {
+                        trianglesOf[edge].push_back(id);
+                    }
+                }
+            }
+        }
+    }
+    std::vector<std::vector<int>> adjacent(triangles.size());
+    for (const auto &entry: trianglesOf) {
+        if (entry.second.size() == 2) {
+            adjacent[entry.second[0]].push_back(entry.second[1]);
+            adjacent[entry.second[1]].push_back(entry.second[0]);
+        }
+    }
+    if (triangles.empty()) {
+        return 1;
+    }
+    // free[v]: matchings of v's subtree leaving v unmatched, matched[v]: those matching v to a child
+    std::vector<double> free(triangles.size(), 1), matched(triangles.size(), 0);
+    std::vector<int> order{0}, parent(triangles.size(), -1);
+    for (size_t i = 0; i < order.size(); ++i) {
+        for (int next: adjacent[order[i]]) {
+            if (next != parent[order[i]]) {
+                parent[next] = order[i];
+                order.push_back(next);
+            }
+        }
+    }
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        int v = *it, p = parent[v];
+        if (p < 0) {
+            continue;
+        }
+        matched[p] = matched[p] * (free[v] + matched[v]) + free[p] * free[v];
+        free[p] *= free[v] + matched[v];
+    }
+    return free[0] + matched[0];
+}
+
+struct InstanceFeatures {
+    static const int COUNT = 7;
+
+    size_t n = 0;
+    unsigned int commonDiagonals = 0;
+    unsigned int goodFlips = 0;
+    // maximum over vertices of the diagonal degree in both triangulations, see bestFanVertex
+    int maxDegreeSum = 0;
+    size_t kernelSize = 0;
+    double sourceSets = 0;
+
+    // Regression inputs, starting with the intercept. Source sets enter logarithmically.
+    std::vector<double> toVector() const {
+        return {1, (double) n, (double) commonDiagonals, (double) goodFlips, (double) maxDegreeSum,
+                (double) kernelSize, std::log2(sourceSets)};
+    }
+};
+
+// Cheap to compute next to any solve: polynomial in n.
+inline InstanceFeatures extractFeatures(const TriangulatedGraph &s, const TriangulatedGraph &t) {
+    InstanceFeatures features;
+    features.n = s.getSize();
+    features.commonDiagonals = commonDiagonalCount(s, t);
+    features.goodFlips = goodFlipCount(s, t);
+    int v = bestFanVertex(s, t);
+    features.maxDegreeSum = diagonalDegree(s, v) + diagonalDegree(t, v);
+    features.kernelSize = kernelSize(s, t);
+    features.sourceSets = sourceSetCount(s);
+    return features;
+}
+
+struct CostSample {
+    InstanceFeatures features;
+    std::string engine;
+    double seconds;
+};
+
+// Per engine linear model of log(seconds) in the instance features, fitted by ridge regression on
+// benchmark runs.
+class CostModel {
+private:
+    // the ridge term keeps features that are constant in the training data from making the system singular
+    static constexpr double RIDGE = 1e-3;
+    static constexpr double MIN_SECONDS = 1e-6;
+
+    std::map<std::string, std::vector<double>> weights;
+
+    // Solves a x = b by Gaussian elimination with partial pivoting.
+    static std::vector<double> solveLinear(std::vector<std::vector<double>> a, std::vector<double> b) {
+        size_t n = b.size();
+        for (size_t col = 0; col < n; ++col) {
+            size_t pivot = col;
+            for (size_t row = col + 1; row < n; ++row) {
+                if (std::fabs(a[row][col]) > std::fabs(a[pivot][col])) {
+                    pivot = row;
+                }
+            }
+            std::swap(a[col], a[pivot]);
+            std::swap(b[col], b[pivot]);
+            for (size_t row = col + 1; row < n; ++row) {
+                double factor = a[row][col] / a[col][col];
+                for (size_t k = col; k < n; ++k) {
+                    a[row][k] -= factor * a[col][k];
+                }
+                b[row] -= factor * b[col];
+            }
+        }
+        std::vector<double> x(n);
+        for (size_t row = n; row-- > 0;) {
+            double sum = b[row];
+            for (size_t k = row + 1; k < n; ++k) {
+                sum -= a[row][k] * x[k];
+            }
+            x[row] = sum / a[row][row];
+        }
+        return x;
+    }
+
+public:
+    void fit(const std::vector<CostSample> &samples) {
+        const int d = InstanceFeatures::COUNT;
+        std::map<std::string, std::pair<std::vector<std::vector<double>>, std::vector<double>>> systems;
+        for (const CostSample &sample: samples) {
+            auto &system = systems[sample.engine];
+            if (system.second.empty()) {
+                system.first.assign(d, std::vector<double>(d, 0));
+                system.second.assign(d, 0);
+                for (int i = 0; i < d; ++i) {
+                    system.first[i][i] = RIDGE;
+                }
+            }
+            std::vector<double> x = sample.features.toVector();
+            double y = std::log(std::max(sample.seconds, MIN_SECONDS));
+            for (int i = 0; i < d; ++i) {
+                for (int j = 0; j < d; ++j) {
+                    system.first[i][j] += x[i] * x[j];
+                }
+                system.second[i] += x[i] * y;
+            }
+        }
+        weights.clear();
+        for (const auto &entry: systems) {
+            weights[entry.first] = solveLinear(entry.second.first, entry.second.second);
+        }
+    }
+
+    bool hasEngine(const std::string &engine) const {
+        return weights.count(engine) > 0;
+    }
+
+    std::vector<std::string> engines() const {
+        std::vector<std::string> result;
+        for (const auto &entry: weights) {
+            result.push_back(entry.first);
+        }
+        return result;
+    }
+
+    // Estimated solve time in seconds; infinite for an engine the model was not trained on.
+    double predict(const InstanceFeatures &features, const std::string &engine) const {
+        auto find = weights.find(engine);
+        if (find == weights.end()) {
+            return INFINITY;
+        }
+        std::vector<double> x = features.toVector();
+        double y = 0;
+        for (size_t i = 0; i < x.size(); ++i) {
+            y += find->second[i] * x[i];
+        }
+        return std::exp(y);
+    }
+
+    // Exact engine with the smallest predicted time; empty if the model knows none. Approximation engines are
+    // passed over even if a model was trained on them, since their answers need not be the distance.
+    std::string bestEngine(const InstanceFeatures &features) const {
+        std::string best;
+        for (const auto &entry: weights) {
+            if (isApproximationEngine(entry.first)) {
+                continue;
+            }
+            if (best.empty() || predict(features, entry.first) < predict(features, best)) {
+                best = entry.first;
+            }
+        }
+        return best;
+    }
+
+    // "<engine> <weight>..." per line, in the order of InstanceFeatures::toVector.
+    bool save(const std::string &path) const {
+        FILE *f = fopen(path.c_str(), "w");
+        if (f == nullptr) {
+            return false;
+        }
+        fprintf(f, "# cost model: ln(seconds) = w . (1, n, common, goodFlips, maxDegreeSum, kernel, log2 sources)\n");
+        for (const auto &entry: weights) {
+            fprintf(f, "%s", entry.first.c_str());
+            for (double w: entry.second) {
+                fprintf(f, " %.17g", w);
+            }
+            fprintf(f, "\n");
+        }
+        return fclose(f) == 0;
+    }
+
+    bool load(const std::string &path) {
+        std::ifstream in(path);
+        if (!in) {
+            return false;
+        }
+        weights.clear();
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::istringstream stream(line);
+            std::string engine;
+            std::vector<double> w(InstanceFeatures::COUNT);
+            stream >> engine;
+            for (double &value: w) {
+                stream >> value;
+            }
+            if (!stream) {
+                return false;
+            }
+            weights[engine] = w;
+        }
+        return true;
+    }
+};
+
+#endif //FLIPDISTANCE_COST_MODEL_H
@@ -6,7 +6,17 @@
 #define FLIPDISTANCE_FLIP_DISTANCE_H
 
 #include "../triangulation/TriangulatedGraph.h"
+#include "search_context.h"
+#include "flip_distance_bounds.h"
+#include "special_instances.h"
 #include <cassert>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "../utils/checkpoint.h"
+#include "../utils/executor.h"
 
 struct Action {
     const int type;
@@ -15,12 +25,143 @@ struct Action {
     Action(int type, Edge edgeStart) : type(type), edge(std::move(edgeStart)) {}
 };
 
+struct SolveRequest {
+    SearchLimits limits;
+    // optional, see SearchContext::progress
+    std::function<void(const FlipDistanceResult &)> onProgress;
+    // optional, called on the solving thread with the final result before the handle becomes ready
+    std::function<void(const FlipDistanceResult &)> onFinished;
+};
+
+// Pending asynchronous solve. Cancelling stops the search at its next check; the future then holds the
+// bounds proven so far, and all search state has been released.
+class SolveHandle {
+private:
+    std::shared_future<FlipDistanceResult> future;
+    CancellationToken token;
+
+public:
+    SolveHandle(std::shared_future<FlipDistanceResult> future, CancellationToken token)
+            : future(std::move(future)), token(std::move(token)) {}
+
+    void cancel() {
+        token.cancel();
+    }
+
+    bool ready() const {
+        return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    const FlipDistanceResult &get() const {
+        return future.get();
+    }
+};
+
 class FlipDistance {
 protected:
     const TriangulatedGraph start;
     const TriangulatedGraph end;
+    std::shared_ptr<SearchContext> context;
+
+    // Sub-solver for a split subproblem; reports into the parent's context.
+    FlipDistance(TriangulatedGraph start, TriangulatedGraph end, const FlipDistance &parent)
+            : start(std::move(start)), end(std::move(end)), context(parent.context) {}
+
+    StatisticsCounters &stats() {
+        return context->statistics.local();
+    }
+
+    // Name of this engine's snapshot in the checkpoint directory.
+    virtual const char *checkpointTag() const {
+        return "solve";
+    }
+
+    std::string checkpointFile() const {
+        return checkpointPath(context->checkpoint.directory, checkpointTag());
+    }
+
+    // Snapshots start with the instance, so they are only resumed against the same pair of triangulations.
+    void writeInstance(CheckpointWriter &writer) const {
+        writer.sizedBits(start.toVector());
+        writer.sizedBits(end.toVector());
+    }
+
+    bool readInstance(CheckpointReader &reader) const {
+        bool same = reader.sizedBits() == start.toVector();
+        same = reader.sizedBits() == end.toVector() && same;
+        if (reader.good() && !same) {
+            fprintf(stderr, "Ignoring checkpoint %s of another instance.\n", checkpointFile().c_str());
+        }
+        return reader.good() && same;
+    }
+
+    // Decisions below k are refuted, and decision k continues at top level source set position.
+    void saveDecisionCheckpoint(unsigned int k, uint64_t position) {
+        if (!context->decisionScan) {
+            return;
+        }
+        CheckpointWriter writer(checkpointFile(), checkpointTag());
+        writeInstance(writer);
+        writer.u32(k);
+        writer.u64(position);
+        if (!writer.commit()) {
+            fprintf(stderr, "Could not write checkpoint %s.\n", checkpointFile().c_str());
+        }
+    }
+
+    void loadDecisionCheckpoint(FlipDistanceResult &result) {
+        CheckpointReader reader(checkpointFile(), checkpointTag());
+        if (!readInstance(reader)) {
+            return;
+        }
+        unsigned int k = reader.u32();
+        uint64_t position = reader.u64();
+        if (reader.good() && k >= result.lowerBound && k <= result.upperBound) {
+            result.lowerBound = k;
+            context->resumePosition = context->decisionPosition = position;
+        }
+    }
+
+    // Tightens result by deciding k = lowerBound, lowerBound + 1, ... with decider until a decision holds,
+    // upperBound is reached or the limits of this solver's context are hit. decider has to share the context.
+    void scanDecisions(FlipDistanceResult &result, FlipDistance &decider) {
+        assert(decider.context == context);
+        if (context->checkpoint.resume) {
+            decider.loadDecisionCheckpoint(result);
+        }
+        context->decisionScan = true;
+        for (auto k = result.lowerBound; k < result.upperBound && !context->checkLimits(); ++k) {
+            bool found = decider.flipDistanceDecision(k);
+            if (context->stopped()) {
+                break;
+            }
+            if (found) {
+                result.upperBound = k;
+                result.path.clear();
+                break;
+            }
+            result.lowerBound = k + 1;
+            context->decisionPosition = 0;
+            context->reportBounds(result);
+            if (context->checkpointDue()) {
+                decider.saveDecisionCheckpoint(result.lowerBound, 0);
+            }
+        }
+        if (context->stopped() && context->checkpointDue()) {
+            decider.saveDecisionCheckpoint(result.lowerBound, context->decisionPosition);
+        }
+        context->decisionScan = false;
+        result.stopReason = context->stopReason;
+        result.exact = result.lowerBound == result.upperBound;
+        if (result.exact && context->checkpoint.enabled()) {
+            removeCheckpoint(decider.checkpointFile());
+        }
+    }
 public:
-    FlipDistance(TriangulatedGraph start, TriangulatedGraph end) : start(std::move(start)), end(std::move(end)) {}
+    FlipDistance(TriangulatedGraph start, TriangulatedGraph end)
+            : start(std::move(start)), end(std::move(end)), context(std::make_shared<SearchContext>()) {}
+
+    virtual ~FlipDistance() = default;
     
     virtual bool flipDistanceDecision(unsigned int k) {
         return false;
@@ -38,10 +179,112 @@ public:
     virtual unsigned int flipDistance() {
         return flipDistance(0, start.getSize() * 2 - 6);
     }
+
+    // Whether the engine has no decision procedure of its own and settles every k by a full solve, so that
+    // deciding several k costs as many solves.
+    virtual bool decidesBySolving() const {
+        return false;
+    }
+
+    // Decision under limits, as the bounds it proved around the fan path: FlipDistanceResult::decides(k) is
+    // empty if the limits stopped it before it was settled, with stopReason telling which, or if the engine
+    // cannot settle k at all, as approximations cannot between their bounds. Engines that decide by solving
+    // return whatever the solve proved, for any k.
+    virtual FlipDistanceResult decideWithin(unsigned int k, const SearchLimits &limits) {
+        if (decidesBySolving()) {
+            return solve(limits);
+        }
+        context->begin(limits);
+        FlipDistanceResult result;
+        int v = bestFanVertex(start, end);
+        result.lowerBound = flipDistanceLowerBound(start, end);
+        result.upperBound = fanDistance(start, end, v);
+        result.path = fanPath(start, end, v);
+        if (k >= result.lowerBound && k < result.upperBound) {
+            bool ret = flipDistanceDecision(k);
+            if (context->stopped()) {
+                result.stopReason = context->stopReason;
+            } else if (ret) {
+                result.upperBound = k;
+                result.path.clear();
+            } else {
+                result.lowerBound = k + 1;
+            }
+        }
+        result.exact = result.lowerBound == result.upperBound;
+        return result;
+    }
+
+    // Anytime solve: answers special instances directly, otherwise scans decisions upwards from the lower
+    // bound against the fan upper bound and, once limits are hit, returns the tightest bounds proven so far.
+    virtual FlipDistanceResult solve(const SearchLimits &limits) {
+        context->begin(limits);
+        if (auto special = solveSpecialInstance(start, end)) {
+            FD_STAT(stats().special());
+            return *special;
+        }
+        FlipDistanceResult result;
+        int v = bestFanVertex(start, end);
+        result.lowerBound = flipDistanceLowerBound(start, end);
+        result.upperBound = fanDistance(start, end, v);
+        result.path = fanPath(start, end, v);
+        scanDecisions(result, *this);
+        return result;
+    }
+
+    FlipDistanceResult solve() {
+        return solve(SearchLimits::none());
+    }
+
+    // Runs solve on executor. The solver must outlive the returned handle's result and must not be used
+    // for another solve until then.
+    SolveHandle solveAsync(SolveRequest request, Executor &executor = Executor::shared()) {
+        CancellationToken token = request.limits.cancellation;
+        auto task = std::make_shared<std::packaged_task<FlipDistanceResult()>>(
+                [this, request = std::move(request)]() {
+                    context->progress = request.onProgress;
+                    FlipDistanceResult result = solve(request.limits);
+                    context->progress = nullptr;
+                    if (request.onFinished) {
+                        request.onFinished(result);
+                    }
+                    return result;
+                });
+        SolveHandle handle(task->get_future().share(), token);
+        executor.submit([task]() { (*task)(); });
+        return handle;
+    }
     
-    virtual std::vector<int> getStatistics() {
-        return {};
+    // Safe to call from any thread while a solve is running.
+    ProgressSnapshot getProgress() const {
+        return context->live.snapshot();
+    }
+
+    StatisticsSnapshot getStatistics() const {
+        return context->statistics.snapshot();
+    }
+
+    void resetStatistics() {
+        context->statistics.reset();
+    }
+
+    // Snapshots of solve are written and resumed as configured by options.
+    void setCheckpoint(const CheckpointOptions &options) {
+        context->checkpoint = options;
+    }
+
+    // Phases of this solver are reported to profiler until it is replaced; nullptr disables profiling.
+    void setProfiler(Profiler *profiler) {
+        context->profiler = profiler;
+    }
+
+    // Spans of this solver are recorded into tracer; nullptr disables tracing.
+    void setTracer(Tracer *tracer) {
+        context->tracer = tracer;
     }
 };
 
+typedef std::function<std::unique_ptr<FlipDistance>(const TriangulatedGraph &, const TriangulatedGraph &)>
+        FlipDistanceFactory;
+
 #endif //FLIPDISTANCE_FLIP_DISTANCE_H
@@ -0,0 +1,65 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_FLIP_DISTANCE_APPROX_H
+#define FLIPDISTANCE_FLIP_DISTANCE_APPROX_H
+
+#include <vector>
+#include "flip_distance.h"
+#include "flip_distance_bounds.h"
+#include "special_instances.h"
+
+// Polynomial time engine for instances no exact engine finishes. It applies the same reductions as the fpt
+// engine, which never lengthen a shortest path: splitting along common diagonals and taking flips that create
+// a diagonal of end. A piece of m vertices where neither applies needs at least m - 2 flips, and is routed
+// through the fan of its best vertex in at most 2(m - 3). The path is therefore shorter than twice the
+// reported lower bound, and both are exact whenever no such piece occurs.
+// Limits are not checked: a solve takes O(n^2 log n) time and always runs to completion.
+class FlipDistanceApprox : public FlipDistance {
+public:
+    FlipDistanceApprox(TriangulatedGraph start, TriangulatedGraph end)
+            : FlipDistance(std::move(start), std::move(end)) {}
+
+    using FlipDistance::solve;
+
+    // The returned bounds satisfy upperBound <= 2 * lowerBound, and path has upperBound flips.
+    FlipDistanceResult solve(const SearchLimits &limits) override {
+        ScopedPhase phase(context->profiler, Phase::Search);
+        context->begin(limits);
+        FlipDistanceResult result;
+        std::vector<InstancePiece> kernels = reduceToKernels(InstancePiece::whole(start, end), result.path);
+        result.lowerBound = (unsigned int) result.path.size();
+        for (InstancePiece &kernel: kernels) {
+            FD_STAT(stats().expand(0));
+            result.lowerBound += (unsigned int) kernel.start.getSize() - 2;
+            for (const auto &flip: flipToFan(kernel.start, bestFanVertex(kernel.start, kernel.end))) {
+                result.path.push_back(kernel.original(flip.first));
+            }
+            // only the flips out of the fan remain, and each of them creates a diagonal of end, so this
+            // leaves no kernel
+            reduceToKernels(std::move(kernel), result.path);
+        }
+        FD_STAT(stats().flip(result.path.size()));
+        result.upperBound = (unsigned int) result.path.size();
+        result.exact = result.lowerBound == result.upperBound;
+        return result;
+    }
+
+    // True only if a path of at most k flips was found.
+    bool flipDistanceDecision(unsigned int k) override {
+        return solve().upperBound <= k;
+    }
+
+    // Decisions are settled only when k lies outside the proven bounds.
+    bool decidesBySolving() const override {
+        return true;
+    }
+
+    // Length of the approximate path, at most twice the flip distance.
+    unsigned int flipDistance() override {
+        return solve().upperBound;
+    }
+};
+
+#endif //FLIPDISTANCE_FLIP_DISTANCE_APPROX_H
@@ -7,37 +7,227 @@
 
 #include <queue>
 #include <vector>
-#include <unordered_set>
+#include <algorithm>
+#include <unordered_map>
 #include "flip_distance.h"
+#include "flip_distance_source.h"
 #include "../triangulation/BinaryString.h"
+#include "../utils/checkpoint.h"
+#include "../utils/memory.h"
+#include "../utils/tracer.h"
 
 class FlipDistanceBfs : public FlipDistance {
+private:
+    typedef std::unordered_map<std::vector<bool>, Edge> VisitedMap;
+
+    static size_t stateBytes(size_t bits) {
+        return (bits + 63) / 64 * sizeof(uint64_t);
+    }
+
+    // Flips leading from start to the state bits, recovered by undoing the diagonal created last.
+    std::vector<Edge> reconstructPath(std::vector<bool> bits, const VisitedMap &visited) const {
+        std::vector<Edge> path;
+        TriangulatedGraph g(bits);
+        while (!(g == start)) {
+            path.push_back(g.flip(visited.at(bits)));
+            bits = g.toVector();
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    // Level dist is being expanded: current holds its unexpanded states and next the states of level
+    // dist + 1 found so far.
+    void saveCheckpoint(int dist, unsigned int lowerBound, const VisitedMap &visited,
+                        const std::queue<std::vector<bool>> &current, const std::queue<std::vector<bool>> &next) {
+        CheckpointWriter writer(checkpointFile(), checkpointTag());
+        writeInstance(writer);
+        writer.u32(dist);
+        writer.u32(lowerBound);
+        writer.u64(visited.size());
+        for (const auto &entry: visited) {
+            writer.bits(entry.first);
+            writer.u32(entry.second.first);
+            writer.u32(entry.second.second);
+        }
+        for (const std::queue<std::vector<bool>> *queue: {&current, &next}) {
+            std::queue<std::vector<bool>> copy = *queue;
+            writer.u64(copy.size());
+            for (; !copy.empty(); copy.pop()) {
+                writer.bits(copy.front());
+            }
+        }
+        if (!writer.commit()) {
+            fprintf(stderr, "Could not write checkpoint %s.\n", checkpointFile().c_str());
+        }
+    }
+
+    // Counterpart of saveCheckpoint; leaves everything untouched and returns false if there is no usable snapshot.
+    bool loadCheckpoint(size_t bits, int &dist, unsigned int &lowerBound, VisitedMap &visited,
+                        std::queue<std::vector<bool>> &current, std::queue<std::vector<bool>> &next) {
+        CheckpointReader reader(checkpointFile(), checkpointTag());
+        if (!readInstance(reader)) {
+            return false;
+        }
+        int storedDist = (int) reader.u32();
+        unsigned int storedLowerBound = reader.u32();
+        VisitedMap storedVisited;
+        std::queue<std::vector<bool>> queues[2];
+        {
+            MemoryCategoryScope category(MemoryCategory::Visited);
+            for (uint64_t i = reader.u64(); i > 0 && reader.good(); --i) {
+                std::vector<bool> state = reader.bits(bits);
+                int first = (int) reader.u32();
+                storedVisited.emplace(std::move(state), Edge(first, (int) reader.u32()));
+            }
+        }
+        for (auto &queue: queues) {
+            MemoryCategoryScope category(MemoryCategory::Frontier);
+            for (uint64_t i = reader.u64(); i > 0 && reader.good(); --i) {
+                queue.push(reader.bits(bits));
+            }
+        }
+        if (!reader.good()) {
+            fprintf(stderr, "Ignoring truncated checkpoint %s.\n", checkpointFile().c_str());
+            return false;
+        }
+        dist = storedDist;
+        lowerBound = std::max(lowerBound, storedLowerBound);
+        visited = std::move(storedVisited);
+        current = std::move(queues[0]);
+        next = std::move(queues[1]);
+        return true;
+    }
+
+    // Memory held after expanding a frontier of the given size into projectedNext new states.
+    static size_t projectedBytes(const VisitedMap &visited, size_t bits, size_t frontier, size_t projectedNext) {
+        return visitedBytes(visited, bits) +
+               projectedNext * (3 * sizeof(void *) + sizeof(std::vector<bool>) + sizeof(Edge) + stateBytes(bits)) +
+               (frontier + projectedNext) * (sizeof(std::vector<bool>) + stateBytes(bits));
+    }
+
+    // Releases the BFS state and lets the Source engine, which needs no memory proportional to the
+    // explored space, continue the decision scan from the lower bound reached so far.
+    void fallBack(FlipDistanceResult &result, int level, VisitedMap &visited,
+                  std::queue<std::vector<bool>> &current, std::queue<std::vector<bool>> &next) {
+        FD_STAT(stats().fallback(level));
+        visited = VisitedMap();
+        current = {};
+        next = {};
+        FlipDistanceSource source(start, end, *this);
+        scanDecisions(result, source);
+    }
+
+protected:
+    const char *checkpointTag() const override {
+        return "bfs";
+    }
+
 public:
-    size_t hashSetSize = 0;
+    // Approximate heap bytes of a visited map: bucket array plus, per entry, a node (next pointer,
+    // cached hash, vector header, creating flip) and the bit storage.
+    static size_t visitedBytes(const VisitedMap &visited, size_t bits) {
+        return visited.bucket_count() * sizeof(void *) +
+               visited.size() * (2 * sizeof(void *) + sizeof(std::vector<bool>) + sizeof(Edge) + stateBytes(bits));
+    }
+
+    static size_t frontierBytes(const std::queue<std::vector<bool>> &queue, size_t bits) {
+        return queue.size() * (sizeof(std::vector<bool>) + stateBytes(bits));
+    }
+
     FlipDistanceBfs(TriangulatedGraph start, TriangulatedGraph end)
             : FlipDistance(std::move(start), std::move(end)) {}
 
+    using FlipDistance::solve;
+
+    bool flipDistanceDecision(unsigned int k) override {
+        return flipDistance() <= k;
+    }
+
+    bool decidesBySolving() const override {
+        return true;
+    }
+
     unsigned int flipDistance() override {
-        std::queue<std::vector<bool>> bfs;
+        FlipDistanceResult result = solve(SearchLimits::none());
+        if (!result.exact) {
+            fprintf(stderr, "Unexpected Error: Flip Distance not found.");
+            return -1;
+        }
+        return result.upperBound;
+    }
+
+    // Each completed level proves one more unit of lower bound; on a hit the path is read back from the
+    // visited map. On stop the fan path stays as the upper bound.
+    // With a memory cap, the next level's size is extrapolated from the growth of the last one; if it would
+    // not fit, or the cap is hit anyway, the search falls back to the Source engine instead of stopping.
+    FlipDistanceResult solve(const SearchLimits &limits) override {
+        ScopedPhase phase(context->profiler, Phase::Search);
+        context->begin(limits);
+        if (auto special = solveSpecialInstance(start, end)) {
+            FD_STAT(stats().special());
+            return *special;
+        }
+        FlipDistanceResult result;
+        int fanVertex = bestFanVertex(start, end);
+        result.lowerBound = flipDistanceLowerBound(start, end);
+        result.upperBound = fanDistance(start, end, fanVertex);
+        result.path = fanPath(start, end, fanVertex);
+        std::queue<std::vector<bool>> bfs, nextQueue;
         std::vector<bool>
                 startBits = start.toBinaryString().getBits();
         bfs.push(startBits);
-        std::unordered_set<std::vector<bool>> set;
-        set.insert(startBits);
-        for (int dist = 1; dist <= 2 * start.getSize() - 6; ++dist) {
-            std::queue<std::vector<bool>> nextQueue;
+        if (context->checkLimits()) {
+            result.stopReason = context->stopReason;
+            return result;
+        }
+        VisitedMap visited;
+        visited.emplace(startBits, Edge());
+        size_t bits = startBits.size();
+        int firstDist = 1;
+        if (context->checkpoint.resume) {
+            loadCheckpoint(bits, firstDist, result.lowerBound, visited, bfs, nextQueue);
+        }
+        size_t previousFrontier = 0;
+        for (int dist = firstDist; dist <= 2 * start.getSize() - 6; ++dist) {
+            if (context->limits.memoryCap > 0 && previousFrontier > 0) {
+                double growth = (double) bfs.size() / (double) previousFrontier;
+                if (projectedBytes(visited, bits, bfs.size(), (size_t) ((double) bfs.size() * growth)) >
+                    context->limits.memoryCap) {
+                    fallBack(result, dist - 1, visited, bfs, nextQueue);
+                    return result;
+                }
+            }
+            size_t levelSize = bfs.size();
+            FD_STAT(stats().frontier(dist - 1, bfs.size()));
+            context->live.level(dist - 1, bfs.size(), result.upperBound);
+            TraceSpan span(context->tracer, SpanKind::BfsLevel, dist - 1, (int) bfs.size(), 0);
             while (!bfs.empty()) {
+                if (context->shouldStop(visitedBytes(visited, bits) + frontierBytes(bfs, bits) +
+                                        frontierBytes(nextQueue, bits))) {
+                    if (context->stopReason == StopReason::MemoryCap) {
+                        context->stopReason = StopReason::None;
+                        fallBack(result, dist - 1, visited, bfs, nextQueue);
+                        return result;
+                    }
+                    if (context->checkpointDue()) {
+                        saveCheckpoint(dist, result.lowerBound, visited, bfs, nextQueue);
+                    }
+                    result.stopReason = context->stopReason;
+                    return result;
+                }
                 std::vector<bool> v(bfs.front());
                 bfs.pop();
+                FD_STAT(stats().expand(dist - 1));
                 TriangulatedGraph g(v);
                 std::vector<Edge> candidates;
                 for (Edge e: g.getEdges()) {
                     if (end.hasEdge(e)) {
                         continue;
                     }
-                    Edge result = g.flip(e);
-                    g.flip(result);
-                    if (end.hasEdge(result)) {
+                    Edge flipped = g.flip(e);
+                    g.flip(flipped);
+                    if (end.hasEdge(flipped)) {
                         candidates.clear();
                         candidates.push_back(e);
                         break;
@@ -45,22 +235,50 @@ public:
                     candidates.push_back(e);
                 }
                 for (Edge e: candidates) {
-                    Edge result = g.flip(e);
-                    if (g == end) {
-                        hashSetSize = set.size();
-                        return dist;
+                    Edge created = g.flip(e);
+                    FD_STAT(stats().flip());
+                    bool found;
+                    {
+                        ScopedPhase check(context->profiler, Phase::FinalCheck);
+                        found = g == end;
+                    }
+                    if (found) {
+                        span.setOutcome(true);
+                        g.flip(created);
+                        result.path = reconstructPath(v, visited);
+                        result.path.push_back(e);
+                        result.lowerBound = result.upperBound = dist;
+                        result.exact = true;
+                        if (context->checkpoint.enabled()) {
+                            removeCheckpoint(checkpointFile());
+                        }
+                        return result;
                     }
                     std::vector<bool> v2 = g.toVector();
-                    g.flip(result);
-                    if(set.insert(v2).second) {
-                        nextQueue.push(v2);
+                    g.flip(created);
+                    bool inserted;
+                    {
+                        MemoryCategoryScope category(MemoryCategory::Visited);
+                        inserted = visited.emplace(v2, created).second;
+                    }
+                    FD_STAT(stats().cacheLookup(!inserted));
+                    if (inserted) {
+                        MemoryCategoryScope category(MemoryCategory::Frontier);
+                        nextQueue.push(std::move(v2));
                     }
                 }
             }
-            bfs = nextQueue;
+            FD_STAT(stats().memory(visitedBytes(visited, bits), frontierBytes(nextQueue, bits)));
+            result.lowerBound = std::max(result.lowerBound, (unsigned int) dist + 1);
+            context->reportBounds(result);
+            previousFrontier = levelSize;
+            bfs = std::move(nextQueue);
+            nextQueue = {};
+            if (context->checkpointDue()) {
+                saveCheckpoint(dist + 1, result.lowerBound, visited, bfs, nextQueue);
+            }
         }
-        fprintf(stderr, "Unexpected Error: Flip Distance not found.");
-        return -1;
+        return result;
     }
 };
 
@@ -0,0 +1,262 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_FLIP_DISTANCE_BFS_BLOOM_H
+#define FLIPDISTANCE_FLIP_DISTANCE_BFS_BLOOM_H
+
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "flip_distance.h"
+#include "../utils/bloom_filter.h"
+#include "../utils/memory.h"
+#include "../utils/tracer.h"
+
+struct BloomBfsOptions {
+    // size of the visited filter; 0 takes half the memory cap, or DEFAULT_FILTER_BYTES without one
+    size_t filterBytes = 0;
+    double falsePositiveRate = 1e-4;
+    // flips around the found path searched exactly by the verification pass; negative skips it
+    int verifyRadius = 1;
+};
+
+// BFS for instances whose visited set does not fit: visited states are kept in a fixed size Bloom filter
+// instead, so only the frontier grows. A false positive drops a state that was never visited, which can only
+// lengthen the path found: the result is an upper bound, exact only where it meets the lower bound.
+// Every state is inserted twice, once for the visited check and once tagged with its level; the path is read
+// back by walking from end through neighbors whose tagged key is on the level before, backtracking past false
+// positives.
+// The verification pass then runs an exact BFS restricted to the states within verifyRadius flips of that
+// path, which confirms its length within the neighbourhood or shortens it.
+class FlipDistanceBfsBloom : public FlipDistance {
+public:
+    static const size_t DEFAULT_FILTER_BYTES = 64 << 20;
+
+private:
+    const BloomBfsOptions options;
+    std::optional<unsigned int> verifiedDistance;
+
+    static uint64_t levelKey(const std::vector<bool> &bits, int level) {
+        return hashBits(bits, (uint64_t) level + 1);
+    }
+
+    static size_t frontierBytes(const std::queue<std::vector<bool>> &queue, size_t bits) {
+        return queue.size() * (sizeof(std::vector<bool>) + (bits + 63) / 64 * sizeof(uint64_t));
+    }
+
+    // Appends to path the flips from start to g, which is on the given level, unless only false positives lead
+    // back. g is left unchanged.
+    bool walkBack(TriangulatedGraph &g, int level, const BlockedBloomFilter &filter, std::vector<Edge> &path) {
+        if (level == 0) {
+            return g == start;
+        }
+        for (Edge e: g.getEdges()) {
+            Edge created = g.flip(e);
+            bool found = filter.contains(levelKey(g.toVector(), level - 1)) && walkBack(g, level - 1, filter, path);
+            g.flip(created);
+            if (found) {
+                path.push_back(created);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Shortest path from start to end through the states within radius flips of path, by exact BFS.
+    std::vector<Edge> shortestNearPath(const std::vector<Edge> &path, int radius) {
+        std::unordered_set<std::vector<bool>> allowed;
+        std::vector<std::vector<bool>> layer;
+        TriangulatedGraph g = start;
+        layer.push_back(g.toVector());
+        for (const Edge &e: path) {
+            g.flip(e);
+            layer.push_back(g.toVector());
+        }
+        allowed.insert(layer.begin(), layer.end());
+        for (int r = 0; r < radius && !context->shouldStop(); ++r) {
+            std::vector<std::vector<bool>> next;
+            for (const auto &bits: layer) {
+                TriangulatedGraph h(bits);
+                for (Edge e: h.getEdges()) {
+                    Edge created = h.flip(e);
+                    std::vector<bool> neighbor = h.toVector();
+                    h.flip(created);
+                    if (allowed.insert(neighbor).second) {
+                        next.push_back(std::move(neighbor));
+                    }
+                }
+            }
+            layer = std::move(next);
+        }
+        // diagonal created by the flip reaching each state
+        std::unordered_map<std::vector<bool>, Edge> parents;
+        std::queue<std::vector<bool>> bfs;
+        std::vector<bool> startBits = start.toVector(), endBits = end.toVector();
+        parents.emplace(startBits, Edge());
+        bfs.push(startBits);
+        while (!bfs.empty() && !parents.count(endBits) && !context->shouldStop()) {
+            TriangulatedGraph h(bfs.front());
+            bfs.pop();
+            for (Edge e: h.getEdges()) {
+                Edge created = h.flip(e);
+                std::vector<bool> neighbor = h.toVector();
+                h.flip(created);
+                if (allowed.count(neighbor) && parents.emplace(neighbor, created).second) {
+                    bfs.push(std::move(neighbor));
+                }
+            }
+        }
+        if (!parents.count(endBits)) {
+            return path;
+        }
+        std::vector<Edge> shortest;
+        TriangulatedGraph h = end;
+        for (std::vector<bool> bits = endBits; !(h == start); bits = h.toVector()) {
+            shortest.push_back(h.flip(parents.at(bits)));
+        }
+        std::reverse(shortest.begin(), shortest.end());
+        return shortest;
+    }
+
+public:
+    FlipDistanceBfsBloom(TriangulatedGraph start, TriangulatedGraph end, BloomBfsOptions options = {})
+            : FlipDistance(std::move(start), std::move(end)), options(options) {}
+
+    using FlipDistance::solve;
+
+    // Length of the path confirmed by the last verification pass, if one ran to completion.
+    std::optional<unsigned int> getVerifiedDistance() const {
+        return verifiedDistance;
+    }
+
+    // One-sided: true proves a path of at most k flips, while false only means that none was found, as false
+    // positives of the filter can hide shorter paths. decideWithin leaves such k undecided instead, above the
+    // lower bound of flipDistanceLowerBound.
+    bool flipDistanceDecision(unsigned int k) override {
+        return solve(SearchLimits::none()).upperBound <= k;
+    }
+
+    bool decidesBySolving() const override {
+        return true;
+    }
+
+    // Upper bound on the flip distance.
+    unsigned int flipDistance() override {
+        return solve(SearchLimits::none()).upperBound;
+    }
+
+    FlipDistanceResult solve(const SearchLimits &limits) override {
+        ScopedPhase phase(context->profiler, Phase::Search);
+        context->begin(limits);
+        verifiedDistance.reset();
+        if (auto special = solveSpecialInstance(start, end)) {
+            FD_STAT(stats().special());
+            return *special;
+        }
+        FlipDistanceResult result;
+        int fanVertex = bestFanVertex(start, end);
+        result.lowerBound = flipDistanceLowerBound(start, end);
+        result.upperBound = fanDistance(start, end, fanVertex);
+        result.path = fanPath(start, end, fanVertex);
+
+        size_t filterBytes = options.filterBytes;
+        if (filterBytes == 0) {
+            filterBytes = limits.memoryCap > 0 ? limits.memoryCap / 2 : DEFAULT_FILTER_BYTES;
+        }
+        std::optional<BlockedBloomFilter> filter;
+        {
+            MemoryCategoryScope category(MemoryCategory::Visited);
+            filter.emplace(filterBytes, BlockedBloomFilter::hashesFor(options.falsePositiveRate));
+        }
+        std::vector<bool> startBits = start.toVector(), endBits = end.toVector();
+        size_t bits = startBits.size();
+        filter->insert(hashBits(startBits));
+        filter->insert(levelKey(startBits, 0));
+        std::queue<std::vector<bool>> bfs, nextQueue;
+        bfs.push(startBits);
+        bool found = false;
+        int dist = 1;
+        for (; dist <= 2 * (int) start.getSize() - 6 && !found && !bfs.empty(); ++dist) {
+            FD_STAT(stats().frontier(dist - 1, bfs.size()));
+            context->live.level(dist - 1, bfs.size(), result.upperBound);
+            TraceSpan span(context->tracer, SpanKind::BfsLevel, dist - 1, (int) bfs.size(), 0);
+            for (; !bfs.empty() && !found; bfs.pop()) {
+                if (context->shouldStop(filter->bytes() + frontierBytes(bfs, bits) + frontierBytes(nextQueue, bits))) {
+                    break;
+                }
+                FD_STAT(stats().expand(dist - 1));
+                TriangulatedGraph g(bfs.front());
+                std::vector<Edge> candidates;
+                for (Edge e: g.getEdges()) {
+                    if (end.hasEdge(e)) {
+                        continue;
+                    }
+                    Edge flipped = g.flip(e);
+                    g.flip(flipped);
+                    if (end.hasEdge(flipped)) {
+                        candidates.clear();
+                        candidates.push_back(e);
+                        break;
+                    }
+                    candidates.push_back(e);
+                }
+                for (Edge e: candidates) {
+                    Edge created = g.flip(e);
+                    FD_STAT(stats().flip());
+                    std::vector<bool> next = g.toVector();
+                    g.flip(created);
+                    // checked first, so that a false positive never drops end itself
+                    if (next == endBits) {
+                        span.setOutcome(true);
+                        found = true;
+                        break;
+                    }
+                    bool seen = filter->insert(hashBits(next));
+                    FD_STAT(stats().cacheLookup(seen));
+                    if (seen) {
+                        continue;
+                    }
+                    filter->insert(levelKey(next, dist));
+                    MemoryCategoryScope category(MemoryCategory::Frontier);
+                    nextQueue.push(std::move(next));
+                }
+            }
+            if (context->stopped()) {
+                break;
+            }
+            FD_STAT(stats().memory(filter->bytes(), frontierBytes(nextQueue, bits)));
+            std::swap(bfs, nextQueue);
+            nextQueue = {};
+        }
+        FD_STAT(stats().filter(options.falsePositiveRate, filter->falsePositiveRate(filter->size())));
+        bfs = {};
+        if (found) {
+            std::vector<Edge> path;
+            TriangulatedGraph g = end;
+            if (walkBack(g, dist - 1, *filter, path) && path.size() < result.upperBound) {
+                result.upperBound = (unsigned int) path.size();
+                result.path = std::move(path);
+            }
+        }
+        filter.reset();
+        if (options.verifyRadius >= 0 && !context->stopped()) {
+            std::vector<Edge> shortest = shortestNearPath(result.path, options.verifyRadius);
+            if (!context->stopped()) {
+                verifiedDistance = (unsigned int) shortest.size();
+                if (shortest.size() < result.upperBound) {
+                    result.upperBound = (unsigned int) shortest.size();
+                    result.path = std::move(shortest);
+                }
+            }
+        }
+        result.exact = result.lowerBound == result.upperBound;
+        result.stopReason = context->stopReason;
+        context->reportBounds(result);
+        return result;
+    }
+};
+
+#endif //FLIPDISTANCE_FLIP_DISTANCE_BFS_BLOOM_H
@@ -0,0 +1,250 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_FLIP_DISTANCE_BFS_SORTED_H
+#define FLIPDISTANCE_FLIP_DISTANCE_BFS_SORTED_H
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "flip_distance.h"
+#include "flip_distance_source.h"
+#include "../utils/executor.h"
+#include "../utils/memory.h"
+#include "../utils/radix_sort.h"
+#include "../utils/tracer.h"
+
+// BFS with delayed duplicate detection. Each state is packed into a 64 bit key; the successors of a level are
+// written to a flat array, sorted with a parallel radix sort and merged against the sorted earlier levels. Every
+// pass is a sequential scan instead of a hash probe per state, and a visited state takes 8 bytes.
+// Keys hold polygons of up to 34 vertices. Larger instances, and instances that hit the memory cap, are left
+// to the Source engine as in FlipDistanceBfs.
+class FlipDistanceBfsSorted : public FlipDistance {
+public:
+    // longest encoding of a state (TriangulatedGraph::toVector) that fits into a key
+    static constexpr size_t MAX_BITS = 64;
+
+    static uint64_t pack(const std::vector<bool> &bits) {
+        uint64_t key = 0;
+        for (size_t i = 0; i < bits.size(); ++i) {
+            key |= (uint64_t) bits[i] << i;
+        }
+        return key;
+    }
+
+    static std::vector<bool> unpack(uint64_t key, size_t bits) {
+        std::vector<bool> result(bits);
+        for (size_t i = 0; i < bits; ++i) {
+            result[i] = (key >> i) & 1;
+        }
+        return result;
+    }
+
+private:
+    // frontiers below this size are expanded on the calling thread only
+    static const size_t PARALLEL_THRESHOLD = 1 << 12;
+
+    const unsigned int threads;
+    // runs the slices other than the calling thread's; started by the first solve and kept across levels and solves
+    std::unique_ptr<Executor> pool;
+
+    static size_t keyBytes(const std::vector<std::vector<uint64_t>> &levels) {
+        size_t total = 0;
+        for (const auto &level: levels) {
+            total += level.capacity() * sizeof(uint64_t);
+        }
+        return total;
+    }
+
+    // Appends the successors of frontier[begin, end) to out, with the flips FlipDistanceBfs takes. Stops early
+    // once found is set, and sets it itself when reaching endKey. heldBytes is the memory of the earlier levels.
+    void expand(const std::vector<uint64_t> &frontier, size_t begin, size_t end, size_t bits, int level,
+                uint64_t endKey, size_t heldBytes, std::atomic<bool> &found, std::vector<uint64_t> &out) {
+        MemoryCategoryScope category(MemoryCategory::Frontier);
+        for (size_t i = begin; i < end && !found.load(std::memory_order_relaxed); ++i) {
+            if (context->shouldStop(heldBytes + out.capacity() * sizeof(uint64_t))) {
+                return;
+            }
+            FD_STAT(stats().expand(level));
+            TriangulatedGraph g(unpack(frontier[i], bits));
+            std::vector<Edge> candidates;
+            for (Edge e: g.getEdges()) {
+                if (this->end.hasEdge(e)) {
+                    continue;
+                }
+                Edge flipped = g.flip(e);
+                g.flip(flipped);
+                if (this->end.hasEdge(flipped)) {
+                    candidates.clear();
+                    candidates.push_back(e);
+                    break;
+                }
+                candidates.push_back(e);
+            }
+            for (Edge e: candidates) {
+                Edge created = g.flip(e);
+                FD_STAT(stats().flip());
+                uint64_t key = pack(g.toBinaryString().getBits());
+                g.flip(created);
+                if (key == endKey) {
+                    found = true;
+                    return;
+                }
+                out.push_back(key);
+            }
+        }
+    }
+
+    // Flips from start to end, found on level distance, by walking back through neighbors on earlier levels.
+    std::vector<Edge> reconstructPath(const std::vector<std::vector<uint64_t>> &levels) const {
+        std::vector<Edge> path;
+        TriangulatedGraph g = end;
+        for (int level = (int) levels.size() - 1; level >= 0; --level) {
+            for (Edge e: g.getEdges()) {
+                Edge created = g.flip(e);
+                if (std::binary_search(levels[level].begin(), levels[level].end(), pack(g.toBinaryString().getBits()))) {
+                    path.push_back(created);
+                    break;
+                }
+                g.flip(created);
+            }
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    void fallBack(FlipDistanceResult &result, int level, std::vector<std::vector<uint64_t>> &levels) {
+        FD_STAT(stats().fallback(level));
+        levels = {};
+        FlipDistanceSource source(start, end, *this);
+        scanDecisions(result, source);
+    }
+
+public:
+    // threads = 0 uses the hardware concurrency
+    FlipDistanceBfsSorted(TriangulatedGraph start, TriangulatedGraph end, unsigned int threads = 0)
+            : FlipDistance(std::move(start), std::move(end)),
+              threads(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())) {}
+
+    using FlipDistance::solve;
+
+    bool flipDistanceDecision(unsigned int k) override {
+        return flipDistance() <= k;
+    }
+
+    bool decidesBySolving() const override {
+        return true;
+    }
+
+    unsigned int flipDistance() override {
+        FlipDistanceResult result = solve(SearchLimits::none());
+        if (!result.exact) {
+            fprintf(stderr, "Unexpected Error: Flip Distance not found.");
+            return -1;
+        }
+        return result.upperBound;
+    }
+
+    // Same bounds and stops as FlipDistanceBfs::solve, without checkpoints. The end is detected while
+    // expanding, so the last level is never sorted.
+    FlipDistanceResult solve(const SearchLimits &limits) override {
+        ScopedPhase phase(context->profiler, Phase::Search);
+        context->begin(limits);
+        if (auto special = solveSpecialInstance(start, end)) {
+            FD_STAT(stats().special());
+            return *special;
+        }
+        FlipDistanceResult result;
+        int fanVertex = bestFanVertex(start, end);
+        result.lowerBound = flipDistanceLowerBound(start, end);
+        result.upperBound = fanDistance(start, end, fanVertex);
+        result.path = fanPath(start, end, fanVertex);
+        std::vector<bool> startBits = start.toBinaryString().getBits();
+        size_t bits = startBits.size();
+        std::vector<std::vector<uint64_t>> levels;
+        if (bits > MAX_BITS) {
+            fallBack(result, 0, levels);
+            return result;
+        }
+        if (threads > 1 && !pool) {
+            pool = std::make_unique<Executor>(threads - 1);
+        }
+        levels.push_back({pack(startBits)});
+        uint64_t endKey = pack(end.toBinaryString().getBits());
+        for (int dist = 1; dist <= 2 * (int) start.getSize() - 6; ++dist) {
+            const std::vector<uint64_t> &frontier = levels.back();
+            FD_STAT(stats().frontier(dist - 1, frontier.size()));
+            context->live.level(dist - 1, frontier.size(), result.upperBound);
+            TraceSpan span(context->tracer, SpanKind::BfsLevel, dist - 1, (int) frontier.size(), 0);
+            unsigned int workers = frontier.size() < PARALLEL_THRESHOLD ? 1 : threads;
+            std::vector<std::vector<uint64_t>> generated(workers);
+            std::atomic<bool> found{false};
+            size_t heldBytes = keyBytes(levels);
+            auto expandSlice = [&](unsigned int t) {
+                expand(frontier, frontier.size() * t / workers, frontier.size() * (t + 1) / workers, bits, dist - 1,
+                       endKey, heldBytes, found, generated[t]);
+            };
+            if (workers > 1) {
+                pool->forEachIndex(workers, expandSlice);
+            } else {
+                expandSlice(0);
+            }
+            if (found) {
+                span.setOutcome(true);
+                result.path = reconstructPath(levels);
+                result.lowerBound = result.upperBound = dist;
+                result.exact = true;
+                return result;
+            }
+            if (context->stopped()) {
+                if (context->stopReason == StopReason::MemoryCap) {
+                    context->stopReason = StopReason::None;
+                    fallBack(result, dist - 1, levels);
+                    return result;
+                }
+                result.stopReason = context->stopReason;
+                return result;
+            }
+            std::vector<uint64_t> next;
+            size_t total = 0;
+            {
+                MemoryCategoryScope category(MemoryCategory::Visited);
+                for (const auto &part: generated) {
+                    total += part.size();
+                }
+                next.reserve(total);
+                for (auto &part: generated) {
+                    next.insert(next.end(), part.begin(), part.end());
+                    part = {};
+                }
+                radixSortUnique(next, threads, pool.get());
+                for (const auto &level: levels) {
+                    removeSorted(next, level);
+                }
+                next.shrink_to_fit();
+            }
+            // as in the hashed BFS, a generated triangulation seen before, in this level or a previous one, is a hit
+            FD_STAT(stats().cacheLookup(true, total - next.size()));
+            FD_STAT(stats().cacheLookup(false, next.size()));
+            FD_STAT(stats().memory(keyBytes(levels), next.size() * sizeof(uint64_t)));
+            levels.push_back(std::move(next));
+            result.lowerBound = std::max(result.lowerBound, (unsigned int) dist + 1);
+            context->reportBounds(result);
+            if (context->checkLimits(keyBytes(levels))) {
+                if (context->stopReason == StopReason::MemoryCap) {
+                    context->stopReason = StopReason::None;
+                    fallBack(result, dist, levels);
+                    return result;
+                }
+                result.stopReason = context->stopReason;
+                return result;
+            }
+        }
+        return result;
+    }
+};
+
+#endif //FLIPDISTANCE_FLIP_DISTANCE_BFS_SORTED_H
@@ -0,0 +1,126 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_FLIP_DISTANCE_BOUNDS_H
+#define FLIPDISTANCE_FLIP_DISTANCE_BOUNDS_H
+
+#include "../triangulation/TriangulatedGraph.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// Number of diagonals present in both triangulations.
+inline unsigned int commonDiagonalCount(const TriangulatedGraph &s, const TriangulatedGraph &t) {
+    unsigned int count = 0;
+    for (const Edge &e: s.getEdges()) {
+        count += t.hasEdge(e);
+    }
+    return count;
+}
+
+// Whether diagonals a and b, with endpoints in increasing order, cross in the interior of the polygon.
+inline bool diagonalsCross(const Edge &a, const Edge &b) {
+    return (a.first < b.first && b.first < a.second && a.second < b.second) ||
+           (b.first < a.first && a.first < b.second && b.second < a.second);
+}
+
+// Number of the given diagonals crossed by d.
+inline int crossingCount(const Edge &d, const std::vector<Edge> &diagonals) {
+    int count = 0;
+    for (const Edge &e: diagonals) {
+        count += diagonalsCross(d, e);
+    }
+    return count;
+}
+
+// Every diagonal of s that is missing from t has to be flipped at least once.
+inline unsigned int flipDistanceLowerBound(const TriangulatedGraph &s, const TriangulatedGraph &t) {
+    return (unsigned int) s.getSize() - 3 - commonDiagonalCount(s, t);
+}
+
+// Number of diagonals incident to v.
+inline int diagonalDegree(const TriangulatedGraph &g, int v) {
+    return (int) g.vertices[v].neighbors.size() - 2;
+}
+
+// Vertex maximizing the diagonal degree sum of both triangulations, i.e. the cheapest fan to route through.
+inline int bestFanVertex(const TriangulatedGraph &s, const TriangulatedGraph &t) {
+    int best = 0;
+    for (int v = 1; v < (int) s.getSize(); ++v) {
+        if (diagonalDegree(s, v) + diagonalDegree(t, v) > diagonalDegree(s, best) + diagonalDegree(t, best)) {
+            best = v;
+        }
+    }
+    return best;
+}
+
+// Length of the path s -> fan(v) -> t.
+inline unsigned int fanDistance(const TriangulatedGraph &s, const TriangulatedGraph &t, int v) {
+    return 2 * ((unsigned int) s.getSize() - 3) - diagonalDegree(s, v) - diagonalDegree(t, v);
+}
+
+inline unsigned int flipDistanceUpperBound(const TriangulatedGraph &s, const TriangulatedGraph &t) {
+    return fanDistance(s, t, bestFanVertex(s, t));
+}
+
+// Flips g into the fan at v. Every flip adds one diagonal at v, so exactly n - 3 - deg(v) flips are made.
+// Returns the (removed, created) diagonal of each flip in order.
+inline std::vector<std::pair<Edge, Edge>> flipToFan(TriangulatedGraph &g, int v) {
+    std::vector<std::pair<Edge, Edge>> flips;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        const std::set<int> &neighbors = g.vertices[v].neighbors;
+        for (auto a = neighbors.begin(); a != neighbors.end() && !changed; ++a) {
+            for (auto b = std::next(a); b != neighbors.end(); ++b) {
+                if (!g.isSimpleEdge(*a, *b) && g.hasEdge(*a, *b)) {
+                    Edge removed(*a, *b);
+                    flips.emplace_back(removed, g.flip(removed));
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+    return flips;
+}
+
+// Flip sequence (diagonals to flip, in order) of length fanDistance(s, t, v) turning s into t.
+inline std::vector<Edge> fanPath(const TriangulatedGraph &s, const TriangulatedGraph &t, int v) {
+    TriangulatedGraph g = s, h = t;
+    std::vector<Edge> path;
+    for (const auto &flip: flipToFan(g, v)) {
+        path.push_back(flip.first);
+    }
+    auto back = flipToFan(h, v);
+    for (auto it = back.rbegin(); it != back.rend(); ++it) {
+        path.push_back(it->second);
+    }
+    return path;
+}
+
+// Checks that flipping path in order turns s into t.
+inline bool isFlipPath(TriangulatedGraph s, const std::vector<Edge> &path, const TriangulatedGraph &t) {
+    for (const Edge &e: path) {
+        if (!s.hasEdge(e) || !s.flippable(e)) {
+            return false;
+        }
+        s.flip(e);
+    }
+    return s == t;
+}
+
+// Space separated "a-b" diagonals, as printed by the command line tools.
+inline std::string flipPathToString(const std::vector<Edge> &path) {
+    std::string out;
+    for (const Edge &e: path) {
+        if (!out.empty()) {
+            out += ' ';
+        }
+        out += std::to_string(e.first) + "-" + std::to_string(e.second);
+    }
+    return out;
+}
+
+#endif //FLIPDISTANCE_FLIP_DISTANCE_BOUNDS_H
@@ -0,0 +1,155 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_FLIP_DISTANCE_FPT_H
+#define FLIPDISTANCE_FLIP_DISTANCE_FPT_H
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "flip_distance.h"
+#include "flip_distance_bounds.h"
+#include "../utils/memory.h"
+#include "../utils/tracer.h"
+
+// Parameterized engine. Kernelization splits the polygon along common diagonals and takes every flip that
+// creates a diagonal of end (some shortest path starts with such a flip, Sleator, Tarjan and Thurston), which
+// leaves subproblems of at most k + 3 vertices each. A reduced subproblem of n' vertices needs at least n' - 2
+// flips, and no flip taken by the branching lowers that bound, so branching only has to go k - (n' - 3) deep:
+// the running time is O(n^2) for the kernel plus a function of k and the excess k - (n - 3) alone.
+class FlipDistanceFpt : public FlipDistance {
+private:
+    // depth of this solver's subproblem in the search tree, for statistics and tracing
+    int depth = 0;
+    // largest budget each reduced state of this subproblem is known to be infeasible with
+    std::unordered_map<std::vector<bool>, int> refuted;
+
+    FlipDistanceFpt(TriangulatedGraph start, TriangulatedGraph end, const FlipDistanceFpt &parent)
+            : FlipDistance(std::move(start), std::move(end), parent), depth(parent.depth + 1) {}
+
+    // Diagonals of g, those crossing the diagonal of end that is crossed least often first: it can only
+    // appear once all of them are gone.
+    std::vector<Edge> branchOrder(const TriangulatedGraph &g) const {
+        std::vector<Edge> diagonals = g.getEdges();
+        Edge target;
+        size_t fewest = SIZE_MAX;
+        for (const Edge &e: end.getEdges()) {
+            size_t crossings = std::count_if(diagonals.begin(), diagonals.end(),
+                                             [&](const Edge &d) { return diagonalsCross(d, e); });
+            if (crossings > 0 && crossings < fewest) {
+                fewest = crossings;
+                target = e;
+            }
+        }
+        std::stable_partition(diagonals.begin(), diagonals.end(), [&](const Edge &d) { return diagonalsCross(d, target); });
+        return diagonals;
+    }
+
+    // Decides the two sides of the common diagonal divider with budget k in total.
+    bool split(const TriangulatedGraph &g, const Edge &divider, int k) {
+        ScopedPhase phase(context->profiler, Phase::Split);
+        TraceSpan span(context->tracer, SpanKind::Split, k, (int) g.getSize(), depth);
+        MemoryCategoryScope category(MemoryCategory::Subproblems);
+        FD_STAT(stats().split());
+        int v1 = divider.first, v2 = divider.second;
+        TriangulatedGraph s1 = g.subGraph(v1, v2), e1 = end.subGraph(v1, v2);
+        TriangulatedGraph s2 = g.subGraph(v2, v1), e2 = end.subGraph(v2, v1);
+        int lower2 = (int) flipDistanceLowerBound(s2, e2);
+        FlipDistanceFpt first(s1, e1, *this);
+        bool ret = false;
+        // the first side's exact distance is the smallest budget it accepts
+        for (int i = (int) flipDistanceLowerBound(s1, e1); i + lower2 <= k && !context->stopped(); ++i) {
+            if (first.decide(s1, i)) {
+                FlipDistanceFpt second(s2, e2, *this);
+                ret = second.decide(s2, k - i);
+                break;
+            }
+        }
+        span.setOutcome(ret);
+        return ret;
+    }
+
+    // g is a triangulation of this solver's polygon.
+    bool decide(TriangulatedGraph g, int k) {
+        if (context->shouldStop()) {
+            return false;
+        }
+        FD_STAT(stats().expand(depth));
+        // kernelization
+        bool reduced = false;
+        while (!reduced) {
+            if (g == end) {
+                return k >= 0;
+            }
+            if ((int) flipDistanceLowerBound(g, end) > k) {
+                return false;
+            }
+            reduced = true;
+            for (const Edge &e: g.getEdges()) {
+                if (end.hasEdge(e)) {
+                    return split(g, e, k);
+                }
+                Edge created = g.flip(e);
+                if (end.hasEdge(created)) {
+                    FD_STAT(stats().flip());
+                    k--;
+                    reduced = false;
+                    break;
+                }
+                g.flip(created);
+            }
+        }
+        // no common diagonal and no good flip: every diagonal goes, and at least one of them twice
+        if ((int) g.getSize() - 2 > k) {
+            return false;
+        }
+        std::vector<bool> state = g.toVector();
+        auto find = refuted.find(state);
+        if (find != refuted.end() && find->second >= k) {
+            FD_STAT(stats().cacheLookup(true));
+            return false;
+        }
+        FD_STAT(stats().cacheLookup(false));
+        for (const Edge &e: branchOrder(g)) {
+            Edge created = g.flip(e);
+            FD_STAT(stats().flip());
+            depth++;
+            bool ret = decide(g, k - 1);
+            depth--;
+            g.flip(created);
+            if (ret) {
+                return true;
+            }
+            if (context->stopped()) {
+                return false;
+            }
+        }
+        MemoryCategoryScope category(MemoryCategory::Visited);
+        int &known = refuted[state];
+        known = std::max(known, k);
+        return false;
+    }
+
+public:
+    FlipDistanceFpt(TriangulatedGraph start, TriangulatedGraph end)
+            : FlipDistance(std::move(start), std::move(end)) {}
+
+    bool flipDistanceDecision(unsigned int k) override {
+        TraceSpan span(context->tracer, SpanKind::Decision, (int) k, (int) start.getSize(), depth);
+        ScopedPhase phase(context->profiler, Phase::Search);
+        if (depth == 0) {
+            context->live.decision((int) k, flipDistanceUpperBound(start, end));
+        }
+        bool ret = decide(start, (int) k);
+        span.setOutcome(ret);
+        return ret;
+    }
+
+protected:
+    const char *checkpointTag() const override {
+        return "fpt";
+    }
+};
+
+#endif //FLIPDISTANCE_FLIP_DISTANCE_FPT_H
@@ -0,0 +1,166 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_FLIP_DISTANCE_PORTFOLIO_H
+#define FLIPDISTANCE_FLIP_DISTANCE_PORTFOLIO_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "flip_distance.h"
+#include "../utils/executor.h"
+
+// Races several engines on the same instance. Every engine gets its own thread and all of them share one
+// cancellation token; bounds reported by any engine are merged, and the race ends as soon as the merged
+// bounds meet. The engine that closed the gap is the winner.
+class FlipDistancePortfolio : public FlipDistance {
+public:
+    typedef std::vector<std::pair<std::string, FlipDistanceFactory>> Engines;
+
+private:
+    const Engines engines;
+    std::string winner;
+    // optional, see setLog
+    std::string logPath;
+
+    void log(const FlipDistanceResult &result, double seconds) const {
+        if (logPath.empty()) {
+            return;
+        }
+        FILE *f = fopen(logPath.c_str(), "a");
+        if (f == nullptr) {
+            fprintf(stderr, "Could not append to %s.\n", logPath.c_str());
+            return;
+        }
+        fprintf(f, "%zu %u %u %s %.6f\n", start.getSize(), result.lowerBound, result.upperBound,
+                winner.empty() ? "-" : winner.c_str(), seconds);
+        fclose(f);
+    }
+
+public:
+    FlipDistancePortfolio(TriangulatedGraph start, TriangulatedGraph end, Engines engines)
+            : FlipDistance(std::move(start), std::move(end)), engines(std::move(engines)) {}
+
+    using FlipDistance::solve;
+
+    bool flipDistanceDecision(unsigned int k) override {
+        return flipDistance() <= k;
+    }
+
+    bool decidesBySolving() const override {
+        return true;
+    }
+
+    unsigned int flipDistance() override {
+        FlipDistanceResult result = solve(SearchLimits::none());
+        if (!result.exact) {
+            fprintf(stderr, "Unexpected Error: Flip Distance not found.");
+            return -1;
+        }
+        return result.upperBound;
+    }
+
+    FlipDistanceResult solve(const SearchLimits &limits) override {
+        auto startTime = std::chrono::steady_clock::now();
+        context->begin(limits);
+        winner.clear();
+        FlipDistanceResult best;
+        int v = bestFanVertex(start, end);
+        best.lowerBound = flipDistanceLowerBound(start, end);
+        best.upperBound = fanDistance(start, end, v);
+        best.path = fanPath(start, end, v);
+        std::mutex mutex;
+        std::condition_variable changed;
+        auto merge = [&](const std::string &name, const FlipDistanceResult &result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            bool improved = false;
+            if (result.lowerBound > best.lowerBound) {
+                best.lowerBound = result.lowerBound;
+                improved = true;
+            }
+            if (result.upperBound < best.upperBound ||
+                (result.upperBound == best.upperBound && best.path.empty() && !result.path.empty())) {
+                improved = improved || result.upperBound < best.upperBound;
+                best.upperBound = result.upperBound;
+                best.path = result.path;
+            }
+            if (improved && winner.empty() && best.lowerBound >= best.upperBound) {
+                winner = name;
+            }
+            if (improved) {
+                context->reportBounds(best);
+                changed.notify_all();
+            }
+        };
+
+        CancellationToken race;
+        size_t finished = 0;
+        std::vector<std::unique_ptr<FlipDistance>> solvers;
+        std::vector<SolveHandle> handles;
+        {
+            Executor pool((unsigned int) engines.size());
+            for (const auto &engine: engines) {
+                solvers.push_back(engine.second(start, end));
+                solvers.back()->setProfiler(context->profiler);
+                solvers.back()->setTracer(context->tracer);
+                SolveRequest request;
+                request.limits = limits;
+                request.limits.cancellation = race;
+                const std::string &name = engine.first;
+                request.onProgress = [&merge, &name](const FlipDistanceResult &result) {
+                    merge(name, result);
+                };
+                request.onFinished = [&](const FlipDistanceResult &result) {
+                    merge(name, result);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    ++finished;
+                    changed.notify_all();
+                };
+                handles.push_back(solvers.back()->solveAsync(request, pool));
+            }
+            while (true) {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (finished == engines.size() || best.lowerBound >= best.upperBound) {
+                    break;
+                }
+                if (limits.cancellation.cancelled()) {
+                    context->stop(StopReason::Cancelled);
+                    break;
+                }
+                // woken by every bound improvement and finished engine; the timeout only bounds the
+                // latency of a cancellation by the caller
+                changed.wait_for(lock, std::chrono::milliseconds(10));
+            }
+            race.cancel();
+            // the pool waits for the cancelled engines here
+        }
+        for (size_t i = 0; i < handles.size(); ++i) {
+            const FlipDistanceResult &result = handles[i].get();
+            merge(engines[i].first, result);
+            if (result.stopReason != StopReason::Cancelled) {
+                context->stop(result.stopReason);
+            }
+        }
+        best.exact = best.lowerBound >= best.upperBound;
+        best.stopReason = best.exact ? StopReason::None : context->stopReason.load();
+        log(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+        return best;
+    }
+
+    // Engine that closed the gap in the last solve; empty if none did.
+    const std::string &getWinner() const {
+        return winner;
+    }
+
+    // Every solve appends "<vertices> <lower bound> <upper bound> <winner> <seconds>" to the file at path.
+    void setLog(std::string path) {
+        logPath = std::move(path);
+    }
+};
+
+#endif //FLIPDISTANCE_FLIP_DISTANCE_PORTFOLIO_H
@@ -0,0 +1,344 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_FLIP_DISTANCE_SHARDED_H
+#define FLIPDISTANCE_FLIP_DISTANCE_SHARDED_H
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+#include "flip_distance.h"
+#include "flip_distance_source.h"
+#include "../utils/bloom_filter.h"
+#include "../utils/checkpoint.h"
+#include "../utils/subprocess.h"
+#include "../utils/tracer.h"
+
+struct ShardedBfsOptions {
+    unsigned int shards = 2;
+    // where the batches between levels are exchanged, e.g. a filesystem shared by several machines; each solve
+    // works in a fresh subdirectory and removes it afterwards. Empty uses the system temporary directory.
+    std::string directory;
+};
+
+// BFS over several worker processes, each owning the visited states whose hash falls into its shard, so memory
+// and expansion work are split across the processes. The coordinator runs the search level by level: every
+// worker reads the batches of states sent to it for the level, keeps the new ones and expands them into one
+// batch file per destination shard for the next level. The path is read back by asking the owner of each state
+// for the diagonal created last, as in FlipDistanceBfs.
+// Limits are checked between levels only, since the workers cannot see the coordinator's cancellation token.
+// If the memory cap is hit, or a worker cannot be started or dies, the search falls back to the Source engine
+// in process.
+class FlipDistanceSharded : public FlipDistance {
+private:
+    typedef std::unordered_map<std::vector<bool>, Edge> VisitedMap;
+
+    // commands from the coordinator; an empty message stops the worker
+    static const uint64_t LEVEL = 1, PARENT = 2;
+    static constexpr const char *BATCH_TAG = "shard-batch";
+
+    const ShardedBfsOptions options;
+    const unsigned int shards;
+
+    unsigned int owner(const std::vector<bool> &bits) const {
+        return (unsigned int) (hashBits(bits) % shards);
+    }
+
+    static std::string batchPath(const std::string &directory, int level, unsigned int from, unsigned int to) {
+        return checkpointPath(directory, "level-" + std::to_string(level) + "-" + std::to_string(from) + "-" +
+                                         std::to_string(to));
+    }
+
+    static std::vector<uint64_t> packBits(const std::vector<bool> &bits) {
+        std::vector<uint64_t> words((bits.size() + 63) / 64);
+        for (size_t i = 0; i < bits.size(); ++i) {
+            words[i / 64] |= (uint64_t) bits[i] << (i % 64);
+        }
+        return words;
+    }
+
+    static std::vector<bool> unpackBits(const uint64_t *words, size_t bits) {
+        std::vector<bool> result(bits);
+        for (size_t i = 0; i < bits; ++i) {
+            result[i] = (words[i / 64] >> (i % 64)) & 1;
+        }
+        return result;
+    }
+
+    static size_t visitedBytes(const VisitedMap &visited, size_t bits) {
+        return visited.size() * (sizeof(VisitedMap::value_type) + (bits + 63) / 64 * sizeof(uint64_t) +
+                                 2 * sizeof(void *));
+    }
+
+    // Reads the batches sent to shard for level, keeping the states not visited yet in frontier. Returns false
+    // if a batch is missing or broken.
+    bool mergeBatches(unsigned int shard, const std::string &directory, int level, size_t bits,
+                      VisitedMap &visited, std::vector<std::vector<bool>> &frontier) const {
+        for (unsigned int from = 0; from < shards; ++from) {
+            std::string path = batchPath(directory, level, from, shard);
+            CheckpointReader reader(path, BATCH_TAG);
+            while (reader.good() && reader.u32() == 1) {
+                std::vector<bool> state = reader.bits(bits);
+                Edge created;
+                created.first = (int) reader.u32();
+                created.second = (int) reader.u32();
+                if (reader.good() && visited.emplace(state, created).second) {
+                    frontier.push_back(std::move(state));
+                }
+            }
+            if (!reader.good()) {
+                return false;
+            }
+            removeCheckpoint(path);
+        }
+        return true;
+    }
+
+    // Writes the successors of frontier to the batches for level, taking the flips FlipDistanceBfs takes.
+    bool expandFrontier(unsigned int shard, const std::string &directory, int level, const VisitedMap &visited,
+                        const std::vector<std::vector<bool>> &frontier, uint64_t &flips) const {
+        std::vector<std::unique_ptr<CheckpointWriter>> batches;
+        for (unsigned int to = 0; to < shards; ++to) {
+            batches.push_back(std::make_unique<CheckpointWriter>(batchPath(directory, level, shard, to), BATCH_TAG));
+        }
+        for (const auto &state: frontier) {
+            TriangulatedGraph g(state);
+            std::vector<Edge> candidates;
+            for (Edge e: g.getEdges()) {
+                if (end.hasEdge(e)) {
+                    continue;
+                }
+                Edge flipped = g.flip(e);
+                g.flip(flipped);
+                if (end.hasEdge(flipped)) {
+                    candidates.clear();
+                    candidates.push_back(e);
+                    break;
+                }
+                candidates.push_back(e);
+            }
+            for (Edge e: candidates) {
+                Edge created = g.flip(e);
+                flips++;
+                std::vector<bool> next = g.toVector();
+                g.flip(created);
+                unsigned int to = owner(next);
+                // states of this shard can be dropped before they are written
+                if (to == shard && visited.count(next)) {
+                    continue;
+                }
+                batches[to]->u32(1);
+                batches[to]->bits(next);
+                batches[to]->u32(created.first);
+                batches[to]->u32(created.second);
+            }
+        }
+        bool ok = true;
+        for (auto &batch: batches) {
+            batch->u32(0);
+            ok = batch->commit() && ok;
+        }
+        return ok;
+    }
+
+    // Main loop of a worker process.
+    int runShard(unsigned int shard, const std::string &directory, int in, int out) const {
+        std::vector<bool> startBits = start.toVector(), endBits = end.toVector();
+        size_t bits = startBits.size();
+        VisitedMap visited;
+        std::vector<std::vector<bool>> frontier;
+        std::vector<uint64_t> command;
+        while (readMessage(in, command) && !command.empty()) {
+            if (command[0] == LEVEL) {
+                // reply: ok, frontier size, whether end was reached, visited bytes, flips
+                int level = (int) command[1];
+                bool ok = true;
+                if (level == 0) {
+                    if (owner(startBits) == shard) {
+                        visited.emplace(startBits, Edge());
+                        frontier.push_back(startBits);
+                    }
+                } else {
+                    ok = mergeBatches(shard, directory, level, bits, visited, frontier);
+                }
+                bool found = visited.count(endBits) > 0;
+                uint64_t flips = 0, size = frontier.size();
+                if (ok && !found) {
+                    ok = expandFrontier(shard, directory, level + 1, visited, frontier, flips);
+                }
+                frontier.clear();
+                writeMessage(out, {ok, size, found, visitedBytes(visited, bits), flips});
+            } else if (command[0] == PARENT) {
+                // reply: whether the state is visited, and the diagonal created last
+                auto find = visited.find(unpackBits(command.data() + 1, bits));
+                if (find == visited.end()) {
+                    writeMessage(out, {0, 0, 0});
+                } else {
+                    writeMessage(out, {1, (uint64_t) find->second.first, (uint64_t) find->second.second});
+                }
+            }
+        }
+        return 0;
+    }
+
+    // Sends command to every worker and collects the replies; false if any worker failed.
+    static bool broadcast(std::vector<std::unique_ptr<Subprocess>> &workers, const std::vector<uint64_t> &command,
+                          std::vector<std::vector<uint64_t>> &replies) {
+        replies.resize(workers.size());
+        for (auto &worker: workers) {
+            if (!worker->send(command)) {
+                return false;
+            }
+        }
+        for (size_t i = 0; i < workers.size(); ++i) {
+            if (!workers[i]->receive(replies[i]) || replies[i].empty() || !replies[i][0]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool reconstructPath(std::vector<std::unique_ptr<Subprocess>> &workers, std::vector<Edge> &path) const {
+        TriangulatedGraph g = end;
+        std::vector<bool> bits = end.toVector();
+        while (!(g == start)) {
+            std::vector<uint64_t> command{PARENT}, reply;
+            for (uint64_t word: packBits(bits)) {
+                command.push_back(word);
+            }
+            Subprocess &worker = *workers[owner(bits)];
+            if (!worker.send(command) || !worker.receive(reply) || reply.size() != 3 || !reply[0]) {
+                return false;
+            }
+            path.push_back(g.flip(Edge((int) reply[1], (int) reply[2])));
+            bits = g.toVector();
+        }
+        std::reverse(path.begin(), path.end());
+        return true;
+    }
+
+    std::string batchDirectory() const {
+        static std::atomic<uint64_t> next{0};
+        std::filesystem::path root = options.directory.empty() ? std::filesystem::temp_directory_path()
+                                                               : std::filesystem::path(options.directory);
+        return (root / ("flipdistance-shards-" + std::to_string(getpid()) + "-" + std::to_string(next++))).string();
+    }
+
+    void fallBack(FlipDistanceResult &result, int level) {
+        FD_STAT(stats().fallback(level));
+        FlipDistanceSource source(start, end, *this);
+        scanDecisions(result, source);
+    }
+
+public:
+    FlipDistanceSharded(TriangulatedGraph start, TriangulatedGraph end, ShardedBfsOptions options = {})
+            : FlipDistance(std::move(start), std::move(end)), options(options), shards(std::max(1u, options.shards)) {}
+
+    using FlipDistance::solve;
+
+    bool flipDistanceDecision(unsigned int k) override {
+        return flipDistance() <= k;
+    }
+
+    bool decidesBySolving() const override {
+        return true;
+    }
+
+    unsigned int flipDistance() override {
+        FlipDistanceResult result = solve(SearchLimits::none());
+        if (!result.exact) {
+            fprintf(stderr, "Unexpected Error: Flip Distance not found.");
+            return -1;
+        }
+        return result.upperBound;
+    }
+
+    FlipDistanceResult solve(const SearchLimits &limits) override {
+        ScopedPhase phase(context->profiler, Phase::Search);
+        context->begin(limits);
+        if (auto special = solveSpecialInstance(start, end)) {
+            FD_STAT(stats().special());
+            return *special;
+        }
+        FlipDistanceResult result;
+        int fanVertex = bestFanVertex(start, end);
+        result.lowerBound = flipDistanceLowerBound(start, end);
+        result.upperBound = fanDistance(start, end, fanVertex);
+        result.path = fanPath(start, end, fanVertex);
+        if (context->checkLimits()) {
+            result.stopReason = context->stopReason;
+            return result;
+        }
+        std::string directory = batchDirectory();
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        std::vector<std::unique_ptr<Subprocess>> workers;
+        bool failed = (bool) error;
+        for (unsigned int shard = 0; shard < shards && !failed; ++shard) {
+            workers.push_back(std::make_unique<Subprocess>([this, shard, &directory](int in, int out) {
+                return runShard(shard, directory, in, out);
+            }));
+            failed = !workers.back()->running();
+        }
+        int dist = 0;
+        for (; dist <= 2 * (int) start.getSize() - 6 && !failed; ++dist) {
+            std::vector<std::vector<uint64_t>> replies;
+            if (!broadcast(workers, {LEVEL, (uint64_t) dist}, replies)) {
+                failed = true;
+                break;
+            }
+            uint64_t size = 0, bytes = 0, flips = 0;
+            bool found = false;
+            for (const auto &reply: replies) {
+                size += reply[1];
+                found = found || reply[2];
+                bytes += reply[3];
+                flips += reply[4];
+            }
+            FD_STAT(stats().frontier(dist, size));
+            FD_STAT(stats().expand(dist, found ? 0 : size));
+            FD_STAT(stats().flip(flips));
+            FD_STAT(stats().memory(bytes, 0));
+            context->live.level(dist, size, result.upperBound);
+            TraceSpan span(context->tracer, SpanKind::BfsLevel, dist, (int) size, 0);
+            if (found) {
+                span.setOutcome(true);
+                std::vector<Edge> path;
+                failed = !reconstructPath(workers, path);
+                if (!failed) {
+                    result.lowerBound = result.upperBound = dist;
+                    result.path = std::move(path);
+                    result.exact = true;
+                }
+                break;
+            }
+            result.lowerBound = std::max(result.lowerBound, (unsigned int) dist + 1);
+            context->reportBounds(result);
+            if (context->checkLimits(bytes)) {
+                break;
+            }
+        }
+        for (auto &worker: workers) {
+            worker->send({});
+            worker->wait();
+        }
+        std::filesystem::remove_all(directory, error);
+        if (failed || context->stopReason == StopReason::MemoryCap) {
+            if (failed) {
+                fprintf(stderr, "Shard worker failed; solving in process.\n");
+            }
+            context->stopReason = StopReason::None;
+            fallBack(result, dist);
+            return result;
+        }
+        result.stopReason = context->stopReason;
+        return result;
+    }
+};
+
+#endif //FLIPDISTANCE_FLIP_DISTANCE_SHARDED_H
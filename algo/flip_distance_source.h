@@ -6,6 +6,10 @@
 #define FLIPDISTANCE_FLIP_DISTANCE_SOURCE_H
 
 #include "flip_distance.h"
+#include "flip_distance_bounds.h"
+#include "source_ordering.h"
+#include "../utils/memory.h"
+#include "../utils/tracer.h"
 #include <algorithm>
 #include <queue>
 #include <vector>
@@ -21,15 +25,34 @@ namespace std {
 
 }
 
-int branchCounter = 0;
-
 class FlipDistanceSource : public FlipDistance {
+private:
+    // depth of this solver's subproblem in the search tree, for statistics and tracing
+    int depth = 0;
+    // nullptr keeps the order of generation
+    std::shared_ptr<SourceOrdering> ordering;
+    // distance of this solver's instance if solveSpecialInstance answers it, once recognized is set
+    bool recognized = false;
+    std::optional<unsigned int> specialDistance;
+
+    FlipDistanceSource(TriangulatedGraph start, TriangulatedGraph end, const FlipDistanceSource &parent)
+            : FlipDistance(std::move(start), std::move(end), parent), depth(parent.depth + 1),
+              ordering(parent.ordering) {}
 
 public:
 
     FlipDistanceSource(TriangulatedGraph start, TriangulatedGraph end)
             : FlipDistance(std::move(start), std::move(end)) {}
 
+    // Top level solver running in the context of another engine, e.g. as its fallback.
+    FlipDistanceSource(TriangulatedGraph start, TriangulatedGraph end, const FlipDistance &owner)
+            : FlipDistance(std::move(start), std::move(end), owner) {}
+
+    // Source sets and flips are tried in the order of ordering, shared with all subproblems.
+    void setOrdering(std::shared_ptr<SourceOrdering> sourceOrdering) {
+        ordering = std::move(sourceOrdering);
+    }
+
     static void addNeighborsToForbid(const Edge &e, const TriangulatedGraph &g,
                                      std::unordered_multiset<Edge> &forbid) {
         forbid.insert(e);
@@ -60,20 +83,28 @@ public:
         if (k <= 0) {
             return g == end && k == 0;
         }
+        ScopedPhase phase(context->profiler, Phase::Split);
+        TraceSpan span(context->tracer, SpanKind::Split, k, (int) g.getSize(), depth);
+        MemoryCategoryScope category(MemoryCategory::Subproblems);
         int v1 = divider.first, v2 = divider.second;
         TriangulatedGraph s1 = g.subGraph(v1, v2), e1 = end.subGraph(v1, v2);
         auto sources1 = g.filterAndMapEdges(v1, v2, sources);
         TriangulatedGraph s2 = g.subGraph(v2, v1), e2 = end.subGraph(v2, v1);
         auto sources2 = g.filterAndMapEdges(v2, v1, sources);
-        FlipDistanceSource algo(s1, e1);
-        for (auto i = s1.getSize() - 3; i <= k; ++i) {
+        FD_STAT(stats().split());
+        FlipDistanceSource algo(s1, e1, *this);
+        bool ret = false;
+        // s1 may still share diagonals with e1, so n - 3 is not a lower bound here
+        for (auto i = flipDistanceLowerBound(s1, e1); i <= k; ++i) {
             // FIXME: use sources1 and sources2
             if (algo.flipDistanceDecision(i)) {
-                FlipDistanceSource algo2(s2, e2);
-                return algo2.flipDistanceDecision(k - i);
+                FlipDistanceSource algo2(s2, e2, *this);
+                ret = algo2.flipDistanceDecision(k - i);
+                break;
             }
         }
-        return false;
+        span.setOutcome(ret);
+        return ret;
     }
 
     static inline void addNeighbors(std::vector<std::pair<Edge, Edge>> &next,
@@ -102,6 +133,10 @@ public:
 
     bool search(const std::vector<std::pair<Edge, Edge>> &sources, TriangulatedGraph g,
                 int k) { // keep as int; possible overflow for unsigned int
+        if (context->shouldStop()) {
+            return false;
+        }
+        FD_STAT(stats().expand(depth));
         // sanity check
         for (const Edge &e : g.getEdges()) {
             assert(!end.hasEdge(e));
@@ -109,6 +144,11 @@ public:
         for (const Edge &e: g.getEdges()) {
             Edge result = g.flip(e);
             if (end.hasEdge(result)) {
+                FD_STAT(stats().flip());
+                FD_STAT(stats().split());
+                ScopedPhase phase(context->profiler, Phase::Split);
+                TraceSpan span(context->tracer, SpanKind::Split, k, (int) g.getSize(), depth);
+                MemoryCategoryScope category(MemoryCategory::Subproblems);
                 k--;
                 std::vector<std::pair<Edge, Edge>> next = sources;
                 next.erase(std::remove_if(next.begin(), next.end(), [=](auto pair) {
@@ -125,27 +165,46 @@ public:
                                                       TriangulatedGraph::getVertexFilter(v2, v1),
                                                       g.getVertexMapper(v2, v1));
                 g.flip(result);
-                FlipDistanceSource algo(s1, e1);
-                for (auto i = s1.getSize() - 3; i <= k; ++i) {
-                    if (algo.search(sources1, s1, (int)i)) {
-                        FlipDistanceSource algo2(s2, e2);
-                        return algo2.search(sources2, s2, int(k - i));
+                FlipDistanceSource algo(s1, e1, *this);
+                bool ret = false;
+                // k may have dropped below 0, so the bound is compared signed
+                for (int i = (int) s1.getSize() - 3; i <= k && !context->stopped(); ++i) {
+                    if (algo.searchPiece(sources1, i)) {
+                        FlipDistanceSource algo2(s2, e2, *this);
+                        ret = algo2.searchPiece(sources2, int(k - i));
+                        break;
                     }
                 }
-                return false;
+                span.setOutcome(ret);
+                return ret;
             }
             g.flip(result);
         }
+        std::vector<std::array<int, 3>> choices(sources.size(), {SourceOrdering::SKIP, SourceOrdering::FIRST,
+                                                                  SourceOrdering::SECOND});
+        if (ordering) {
+            ordering->orderChoices(g, end, sources, choices);
+        }
         std::vector<Edge> cur;
         std::unordered_multiset<Edge> forbid;
         std::function<bool(int)> generateNext = [&](int index) -> bool {
             if (index == sources.size()) {
-                return search(cur, g, k);
-            }
-            if (generateNext(index + 1)) {
-                return true;
+                depth++;
+                bool ret = search(cur, g, k);
+                depth--;
+                return ret;
             }
-            for (const Edge &e: {sources[index].first, sources[index].second}) {
+            for (int choice: choices[index]) {
+                if (choice == SourceOrdering::SKIP) {
+                    if (generateNext(index + 1)) {
+                        return true;
+                    }
+                    if (context->stopped()) {
+                        return false;
+                    }
+                    continue;
+                }
+                const Edge &e = choice == SourceOrdering::FIRST ? sources[index].first : sources[index].second;
                 if (!g.flippable(e) || forbid.count(e) > 0) {
                     continue;
                 }
@@ -176,7 +235,10 @@ public:
 
     bool search(const std::vector<Edge> &sources, TriangulatedGraph g,
                 int k) { // keep as int; possible overflow for unsigned int
-        branchCounter++;
+        if (context->shouldStop()) {
+            return false;
+        }
+        FD_STAT(stats().expand(depth));
         // sanity check
         for (const Edge &e: g.getEdges()) {
             Edge result = g.flip(e);
@@ -186,7 +248,12 @@ public:
         }
         assert(isIndependentSet(sources, g));
         
-        if (g == end && k >= 0) {
+        bool found;
+        {
+            ScopedPhase check(context->profiler, Phase::FinalCheck);
+            found = g == end;
+        }
+        if (found && k >= 0) {
             return true;
         }
         if (g.getSize() - 3 > k) {
@@ -198,6 +265,7 @@ public:
         for (const Edge &e: g.getEdges()) {
             Edge result = g.flip(e);
             if (end.hasEdge(result)) {
+                FD_STAT(stats().flip());
                 bool ret = std::count(sources.begin(), sources.end(), e) > 0 &&
                            splitAndSearch(g, result, k - 1, sources);
                 g.flip(result);
@@ -211,8 +279,12 @@ public:
             Edge result = g.flip(e);
             addNeighbors(next, g, result);
         }
+        FD_STAT(stats().flip(sources.size()));
         k -= (int) sources.size();
-        return search(next, g, k);
+        depth++;
+        bool ret = search(next, g, k);
+        depth--;
+        return ret;
     }
 
     bool flipDistanceDecision(unsigned int k, const std::vector<Edge> &source) {
@@ -221,8 +293,46 @@ public:
     }
 
     bool flipDistanceDecision(unsigned int k) override {
-        if (start == end) {
-            return true;
+        TraceSpan span(context->tracer, SpanKind::Decision, (int) k, (int) start.getSize(), depth);
+        bool ret = decide(k);
+        span.setOutcome(ret);
+        return ret;
+    }
+
+protected:
+    const char *checkpointTag() const override {
+        return "source";
+    }
+
+private:
+    const std::optional<unsigned int> &special() {
+        if (!recognized) {
+            recognized = true;
+            if (auto special = solveSpecialInstance(start, end)) {
+                specialDistance = special->upperBound;
+            }
+        }
+        return specialDistance;
+    }
+
+    // search of this solver's instance, a piece of a split, unless solveSpecialInstance answers it. Its
+    // distance decides the piece at least as well as the sources do.
+    bool searchPiece(const std::vector<std::pair<Edge, Edge>> &sources, int k) {
+        if (special()) {
+            FD_STAT(stats().special());
+            return (int) *specialDistance <= k;
+        }
+        return search(sources, start, k);
+    }
+
+    bool decide(unsigned int k) {
+        if (special()) {
+            FD_STAT(stats().special());
+            return *specialDistance <= k;
+        }
+        ScopedPhase phase(context->profiler, Phase::Search);
+        if (depth == 0) {
+            context->live.decision((int) k, flipDistanceUpperBound(start, end));
         }
         TriangulatedGraph g = start;
         for (Edge e: g.getEdges()) {
@@ -231,24 +341,48 @@ public:
             }
             Edge result = g.flip(e);
             if (end.hasEdge(result)) {
+                FD_STAT(stats().flip());
                 bool ret = splitAndSearch(g, result, (int)k - 1, {});
                 g.flip(result);
                 return ret;
             }
             g.flip(result);
         }
-        std::vector<std::vector<Edge>> sources = start.getSources();
-        for (const auto &source: sources) {
-            if (flipDistanceDecision(k, source)) {
+        std::vector<std::vector<Edge>> sources;
+        {
+            ScopedPhase sourcesPhase(context->profiler, Phase::Sources);
+            MemoryCategoryScope category(MemoryCategory::Sources);
+            sources = start.getSources();
+            if (ordering) {
+                ordering->orderSources(start, end, sources);
+            }
+        }
+        size_t first = 0;
+        if (depth == 0) {
+            first = !ordering || ordering->stable() ? context->resumePosition : 0;
+            context->resumePosition = 0;
+        }
+        for (size_t i = first; i < sources.size() && !context->stopped(); ++i) {
+            FD_STAT(stats().sourceSet());
+            if (depth == 0) {
+                context->live.source(i + 1, sources.size());
+                context->decisionPosition = i;
+                if (context->checkpointDue()) {
+                    saveDecisionCheckpoint(k, i);
+                }
+            }
+            TraceSpan span(context->tracer, SpanKind::SourceSet, (int) k, (int) start.getSize(), depth, (int) i);
+            bool ret = flipDistanceDecision(k, sources[i]);
+            span.setOutcome(ret);
+            if (ret) {
+                if (ordering && depth == 0) {
+                    ordering->solved(start, sources[i]);
+                }
                 return true;
             }
         }
         return false;
     }
-
-    std::vector<int> getStatistics() override {
-        return {branchCounter};
-    }
 };
 
 #endif //FLIPDISTANCE_FLIP_DISTANCE_SOURCE_H
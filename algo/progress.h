@@ -0,0 +1,137 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_PROGRESS_H
+#define FLIPDISTANCE_PROGRESS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+struct ProgressSnapshot {
+    // -1 where the engine has not reported the field
+    int k = -1;
+    int bfsLevel = -1;
+    uint64_t frontierSize = 0;
+    uint64_t sourceIndex = 0;
+    uint64_t sourceTotal = 0;
+    uint64_t nodes = 0;
+    double elapsedSeconds = 0;
+    double nodesPerSecond = 0;
+    // time until the remaining stages (decisions or BFS levels up to the upper bound) are done, assuming each
+    // takes as much longer than the previous one as the last did; negative while unknown
+    double etaSeconds = -1;
+
+    std::string toString() const {
+        char buffer[256];
+        snprintf(buffer, sizeof(buffer),
+                 "k=%d level=%d frontier=%llu source=%llu/%llu nodes=%llu rate=%.0f/s elapsed=%.1fs eta=%s",
+                 k, bfsLevel, (unsigned long long) frontierSize, (unsigned long long) sourceIndex,
+                 (unsigned long long) sourceTotal, (unsigned long long) nodes, nodesPerSecond, elapsedSeconds,
+                 etaSeconds < 0 ? "?" : (std::to_string((long long) std::ceil(etaSeconds)) + "s").c_str());
+        return buffer;
+    }
+};
+
+// Written by the solving threads with relaxed stores and read from any thread through snapshot().
+// A stage is one decision k, or one BFS level.
+class Progress {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::atomic<Clock::rep> startTicks{Clock::now().time_since_epoch().count()};
+    std::atomic<int> k{-1};
+    std::atomic<int> bfsLevel{-1};
+    std::atomic<uint64_t> frontierSize{0};
+    std::atomic<uint64_t> sourceIndex{0};
+    std::atomic<uint64_t> sourceTotal{0};
+    std::atomic<uint64_t> nodes{0};
+    std::atomic<double> stageStart{0};
+    std::atomic<double> lastStageSeconds{-1};
+    std::atomic<double> growth{1};
+    std::atomic<int> stagesLeft{0};
+
+    double secondsSinceStart() const {
+        return std::chrono::duration<double>(
+                Clock::now().time_since_epoch() - Clock::duration(startTicks.load(std::memory_order_relaxed))).count();
+    }
+
+    void stage(int value, unsigned int upperBound) {
+        double now = secondsSinceStart();
+        double previous = lastStageSeconds.load(std::memory_order_relaxed);
+        double length = now - stageStart.load(std::memory_order_relaxed);
+        if (previous > 0 && length > 0) {
+            growth.store(length / previous, std::memory_order_relaxed);
+        }
+        lastStageSeconds.store(length, std::memory_order_relaxed);
+        stageStart.store(now, std::memory_order_relaxed);
+        stagesLeft.store(std::max(0, (int) upperBound - value), std::memory_order_relaxed);
+    }
+
+public:
+    void reset() {
+        startTicks.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        k = -1;
+        bfsLevel = -1;
+        frontierSize = sourceIndex = sourceTotal = nodes = 0;
+        stageStart = 0;
+        lastStageSeconds = -1;
+        growth = 1;
+        stagesLeft = 0;
+    }
+
+    void decision(int value, unsigned int upperBound) {
+        k.store(value, std::memory_order_relaxed);
+        sourceIndex.store(0, std::memory_order_relaxed);
+        sourceTotal.store(0, std::memory_order_relaxed);
+        stage(value, upperBound);
+    }
+
+    void level(int value, uint64_t frontier, unsigned int upperBound) {
+        bfsLevel.store(value, std::memory_order_relaxed);
+        frontierSize.store(frontier, std::memory_order_relaxed);
+        stage(value, upperBound);
+    }
+
+    void source(uint64_t index, uint64_t total) {
+        sourceIndex.store(index, std::memory_order_relaxed);
+        sourceTotal.store(total, std::memory_order_relaxed);
+    }
+
+    void expanded(uint64_t count) {
+        nodes.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    ProgressSnapshot snapshot() const {
+        ProgressSnapshot snapshot;
+        snapshot.k = k.load(std::memory_order_relaxed);
+        snapshot.bfsLevel = bfsLevel.load(std::memory_order_relaxed);
+        snapshot.frontierSize = frontierSize.load(std::memory_order_relaxed);
+        snapshot.sourceIndex = sourceIndex.load(std::memory_order_relaxed);
+        snapshot.sourceTotal = sourceTotal.load(std::memory_order_relaxed);
+        snapshot.nodes = nodes.load(std::memory_order_relaxed);
+        snapshot.elapsedSeconds = secondsSinceStart();
+        if (snapshot.elapsedSeconds > 0) {
+            snapshot.nodesPerSecond = (double) snapshot.nodes / snapshot.elapsedSeconds;
+        }
+        double last = lastStageSeconds.load(std::memory_order_relaxed);
+        if (last > 0) {
+            double g = growth.load(std::memory_order_relaxed);
+            double inStage = snapshot.elapsedSeconds - stageStart.load(std::memory_order_relaxed);
+            double eta = 0, length = last;
+            for (int i = 0; i < stagesLeft.load(std::memory_order_relaxed) && eta < 1e9; ++i) {
+                length *= g;
+                eta += length;
+            }
+            snapshot.etaSeconds = std::max(0.0, eta - inStage);
+        }
+        return snapshot;
+    }
+};
+
+#endif //FLIPDISTANCE_PROGRESS_H
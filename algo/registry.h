@@ -0,0 +1,118 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_REGISTRY_H
+#define FLIPDISTANCE_REGISTRY_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "flip_distance.h"
+#include "flip_distance_approx.h"
+#include "flip_distance_bfs.h"
+#include "flip_distance_bfs_bloom.h"
+#include "flip_distance_bfs_sorted.h"
+#include "flip_distance_fpt.h"
+#include "flip_distance_portfolio.h"
+#include "flip_distance_sharded.h"
+#include "flip_distance_source.h"
+
+template<class T>
+std::unique_ptr<FlipDistance> makeEngine(const TriangulatedGraph &start, const TriangulatedGraph &end) {
+    return std::make_unique<T>(start, end);
+}
+
+inline const std::vector<std::pair<std::string, FlipDistanceFactory>> &flipDistanceEngines();
+
+// Source engine trying the source sets and flips that make the most progress towards end first.
+inline std::unique_ptr<FlipDistance> makeScoredSource(const TriangulatedGraph &start, const TriangulatedGraph &end) {
+    auto engine = std::make_unique<FlipDistanceSource>(start, end);
+    engine->setOrdering(std::make_shared<ScoredSourceOrdering>());
+    return engine;
+}
+
+// Sharded engines with the given worker count and batch directory, for the tools taking them as options.
+inline FlipDistanceFactory makeSharded(ShardedBfsOptions options) {
+    return [options](const TriangulatedGraph &start, const TriangulatedGraph &end) -> std::unique_ptr<FlipDistance> {
+        return std::make_unique<FlipDistanceSharded>(start, end, options);
+    };
+}
+
+// Races every other registered engine, except the sharded one, whose worker processes would compete with the
+// portfolio's threads for the same cores.
+inline std::unique_ptr<FlipDistance> makePortfolio(const TriangulatedGraph &start, const TriangulatedGraph &end) {
+    FlipDistancePortfolio::Engines engines;
+    for (const auto &engine: flipDistanceEngines()) {
+        if (engine.first != "portfolio" && engine.first != "sharded") {
+            engines.push_back(engine);
+        }
+    }
+    return std::make_unique<FlipDistancePortfolio>(start, end, std::move(engines));
+}
+
+// Every engine selectable by name, in the order the tools run them. The first one is the reference.
+inline const std::vector<std::pair<std::string, FlipDistanceFactory>> &flipDistanceEngines() {
+    static const std::vector<std::pair<std::string, FlipDistanceFactory>> engines = {
+            {"bfs",        makeEngine<FlipDistanceBfs>},
+            {"bfs-sorted", makeEngine<FlipDistanceBfsSorted>},
+            {"source",     makeEngine<FlipDistanceSource>},
+            {"scored",     makeScoredSource},
+            {"fpt",        makeEngine<FlipDistanceFpt>},
+            {"sharded",    makeSharded(ShardedBfsOptions())},
+            {"portfolio",  makePortfolio},
+    };
+    return engines;
+}
+
+// Engines returning a path within a guaranteed factor of the distance instead of the distance. They are
+// selectable by name but left out of flipDistanceEngines, whose users expect exact answers.
+inline const std::vector<std::pair<std::string, FlipDistanceFactory>> &approximationEngines() {
+    static const std::vector<std::pair<std::string, FlipDistanceFactory>> engines = {
+            {"approx",    makeEngine<FlipDistanceApprox>},
+            {"bfs-bloom", makeEngine<FlipDistanceBfsBloom>},
+    };
+    return engines;
+}
+
+inline bool isApproximationEngine(const std::string &name) {
+    for (const auto &engine: approximationEngines()) {
+        if (engine.first == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// nullptr unless name is one of flipDistanceEngines, which return exact distances.
+inline const FlipDistanceFactory *findExactEngine(const std::string &name) {
+    for (const auto &engine: flipDistanceEngines()) {
+        if (engine.first == name) {
+            return &engine.second;
+        }
+    }
+    return nullptr;
+}
+
+// nullptr if no engine is registered under name.
+inline const FlipDistanceFactory *findFlipDistanceFactory(const std::string &name) {
+    for (const auto *engines: {&flipDistanceEngines(), &approximationEngines()}) {
+        for (const auto &engine: *engines) {
+            if (engine.first == name) {
+                return &engine.second;
+            }
+        }
+    }
+    return nullptr;
+}
+
+// nullptr if no engine is registered under name.
+inline std::unique_ptr<FlipDistance> makeFlipDistance(const std::string &name, const TriangulatedGraph &start,
+                                                      const TriangulatedGraph &end) {
+    const FlipDistanceFactory *factory = findFlipDistanceFactory(name);
+    return factory == nullptr ? nullptr : (*factory)(start, end);
+}
+
+#endif //FLIPDISTANCE_REGISTRY_H
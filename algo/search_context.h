@@ -0,0 +1,200 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_SEARCH_CONTEXT_H
+#define FLIPDISTANCE_SEARCH_CONTEXT_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "progress.h"
+#include "statistics.h"
+#include "../triangulation/Edge.h"
+#include "../utils/memory.h"
+#include "../utils/profiler.h"
+#include "../utils/tracer.h"
+
+enum class StopReason {
+    None, Deadline, MemoryCap, Cancelled
+};
+
+inline const char *stopReasonName(StopReason reason) {
+    switch (reason) {
+        case StopReason::None:
+            return "none";
+        case StopReason::Deadline:
+            return "deadline";
+        case StopReason::MemoryCap:
+            return "memory";
+        case StopReason::Cancelled:
+            return "cancelled";
+        default:
+            return "unknown";
+    }
+}
+
+// Copies share one flag, so a token handed to a solve can be cancelled from any thread holding a copy.
+class CancellationToken {
+private:
+    std::shared_ptr<std::atomic<bool>> flag = std::make_shared<std::atomic<bool>>(false);
+
+public:
+    void cancel() {
+        flag->store(true, std::memory_order_relaxed);
+    }
+
+    bool cancelled() const {
+        return flag->load(std::memory_order_relaxed);
+    }
+};
+
+// Outcome of a limited solve: the distance lies in [lowerBound, upperBound], and both are equal when exact.
+// path, when non-empty, is a flip sequence of length upperBound in the format of fanPath.
+struct FlipDistanceResult {
+    bool exact = false;
+    unsigned int lowerBound = 0;
+    unsigned int upperBound = 0;
+    std::vector<Edge> path;
+    StopReason stopReason = StopReason::None;
+
+    // Whether the distance is at most k, if the bounds settle it.
+    std::optional<bool> decides(unsigned int k) const {
+        if (upperBound <= k || lowerBound > k) {
+            return upperBound <= k;
+        }
+        return std::nullopt;
+    }
+};
+
+struct SearchLimits {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    // bytes, 0 for no cap
+    uint64_t memoryCap = 0;
+    CancellationToken cancellation;
+
+    static SearchLimits none() {
+        return {};
+    }
+
+    static SearchLimits within(double seconds, uint64_t memoryCap = 0) {
+        SearchLimits limits;
+        limits.deadline = std::chrono::steady_clock::now() +
+                          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                  std::chrono::duration<double>(seconds));
+        limits.memoryCap = memoryCap;
+        return limits;
+    }
+};
+
+struct CheckpointOptions {
+    // snapshots are written here; empty disables checkpointing
+    std::string directory;
+    // minimum time between two periodic snapshots; one is always written when a solve stops early
+    double intervalSeconds = 60;
+    // continue from the snapshot in directory, if there is one for the same instance
+    bool resume = false;
+
+    bool enabled() const {
+        return !directory.empty();
+    }
+};
+
+// State shared by a solver and every sub-solver it creates for split subproblems.
+struct SearchContext {
+    // the clock is read once per this many node expansions
+    static const unsigned int CHECK_INTERVAL = 256;
+
+    Statistics statistics;
+    // optional, owned by the caller
+    Profiler *profiler = nullptr;
+    Tracer *tracer = nullptr;
+
+    SearchLimits limits;
+    std::atomic<StopReason> stopReason{StopReason::None};
+    // called from the solving thread whenever a bound improves
+    std::function<void(const FlipDistanceResult &)> progress;
+    Progress live;
+
+    CheckpointOptions checkpoint;
+    std::chrono::steady_clock::time_point lastCheckpoint;
+    // set while solve scans decisions upwards, i.e. every decision below the running one is refuted
+    bool decisionScan = false;
+    // top level source set the running decision is at, and the one the next decision starts from
+    uint64_t decisionPosition = 0;
+    uint64_t resumePosition = 0;
+
+    void begin(const SearchLimits &searchLimits) {
+        limits = searchLimits;
+        stopReason = StopReason::None;
+        live.reset();
+        lastCheckpoint = std::chrono::steady_clock::now();
+        decisionPosition = resumePosition = 0;
+    }
+
+    // True if a snapshot should be written now: always after a stop, otherwise once per interval.
+    bool checkpointDue() {
+        if (!checkpoint.enabled()) {
+            return false;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (!stopped() && std::chrono::duration<double>(now - lastCheckpoint).count() < checkpoint.intervalSeconds) {
+            return false;
+        }
+        lastCheckpoint = now;
+        return true;
+    }
+
+    void stop(StopReason reason) {
+        StopReason expected = StopReason::None;
+        stopReason.compare_exchange_strong(expected, reason);
+    }
+
+    bool stopped() const {
+        return stopReason.load(std::memory_order_relaxed) != StopReason::None;
+    }
+
+    // Cooperative limit check, called once per node expansion. usedBytes is the caller's estimate of the
+    // memory it holds; with allocation accounting enabled the live heap is used when larger.
+    bool shouldStop(uint64_t usedBytes = 0) {
+        if (stopped()) {
+            return true;
+        }
+        if (limits.cancellation.cancelled()) {
+            stop(StopReason::Cancelled);
+            return true;
+        }
+        thread_local unsigned int countdown = 0;
+        if (countdown-- > 0) {
+            return false;
+        }
+        countdown = CHECK_INTERVAL - 1;
+        live.expanded(CHECK_INTERVAL);
+        return checkLimits(usedBytes);
+    }
+
+    // Unthrottled variant of shouldStop for coarse-grained points such as the start of a decision.
+    bool checkLimits(uint64_t usedBytes = 0) {
+        if (limits.cancellation.cancelled()) {
+            stop(StopReason::Cancelled);
+        } else if (std::chrono::steady_clock::now() >= limits.deadline) {
+            stop(StopReason::Deadline);
+        } else if (limits.memoryCap > 0 && std::max(usedBytes, liveHeapBytes()) > limits.memoryCap) {
+            stop(StopReason::MemoryCap);
+        }
+        return stopped();
+    }
+
+    void reportBounds(const FlipDistanceResult &result) const {
+        if (progress) {
+            progress(result);
+        }
+    }
+};
+
+#endif //FLIPDISTANCE_SEARCH_CONTEXT_H
@@ -0,0 +1,206 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_SHORTEST_PATHS_H
+#define FLIPDISTANCE_SHORTEST_PATHS_H
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <vector>
+#include "flip_distance_bfs_sorted.h"
+#include "search_context.h"
+#include "../utils/big_unsigned.h"
+#include "../utils/radix_sort.h"
+
+// Every shortest flip path between two triangulations, as a DAG layered by the distance from start. A plain BFS
+// over all flips (the pruning rules of the engines keep only some shortest paths) finds the levels, and a
+// backward pass from end keeps the states on a shortest path. Each kept state stores the diagonals leading to
+// the previous level as one bit mask, in TriangulatedGraph::getEdges order.
+// States are packed keys as in FlipDistanceBfsSorted, so polygons are limited to 34 vertices; the levels
+// up to the distance have to fit into memory.
+class ShortestPathDag {
+private:
+    TriangulatedGraph start, end;
+    size_t bits;
+    // states on a shortest path by distance from start, sorted
+    std::vector<std::vector<uint64_t>> levels;
+    // per state of levels[j], bit i set if flipping its i-th diagonal leads to levels[j - 1]
+    std::vector<std::vector<uint64_t>> predecessors;
+
+    ShortestPathDag(TriangulatedGraph start, TriangulatedGraph end)
+            : start(std::move(start)), end(std::move(end)), bits(this->start.toVector().size()) {}
+
+    static uint64_t neighborKey(TriangulatedGraph &g, const Edge &e) {
+        Edge created = g.flip(e);
+        uint64_t key = FlipDistanceBfsSorted::pack(g.toVector());
+        g.flip(created);
+        return key;
+    }
+
+    size_t indexOf(int level, uint64_t key) const {
+        return std::lower_bound(levels[level].begin(), levels[level].end(), key) - levels[level].begin();
+    }
+
+    uint64_t predecessorMask(int level, uint64_t key) const {
+        return predecessors[level][indexOf(level, key)];
+    }
+
+    static bool stopped(const SearchLimits &limits, size_t heldKeys) {
+        return limits.cancellation.cancelled() || std::chrono::steady_clock::now() >= limits.deadline ||
+               (limits.memoryCap > 0 && heldKeys * sizeof(uint64_t) > limits.memoryCap);
+    }
+
+public:
+    // Empty if the limits stop the search, which they are checked against once per level, or if the polygon
+    // has more than 34 vertices.
+    static std::optional<ShortestPathDag> build(const TriangulatedGraph &start, const TriangulatedGraph &end,
+                                                const SearchLimits &limits = SearchLimits::none()) {
+        ShortestPathDag dag(start, end);
+        if (dag.bits > FlipDistanceBfsSorted::MAX_BITS) {
+            return std::nullopt;
+        }
+        uint64_t endKey = FlipDistanceBfsSorted::pack(end.toVector());
+        // forward: all states by distance from start, until end is reached
+        std::vector<std::vector<uint64_t>> forward{{FlipDistanceBfsSorted::pack(start.toVector())}};
+        size_t heldKeys = 1;
+        while (!std::binary_search(forward.back().begin(), forward.back().end(), endKey)) {
+            if (stopped(limits, heldKeys)) {
+                return std::nullopt;
+            }
+            std::vector<uint64_t> next;
+            for (uint64_t key: forward.back()) {
+                TriangulatedGraph g(FlipDistanceBfsSorted::unpack(key, dag.bits));
+                for (const Edge &e: g.getEdges()) {
+                    next.push_back(neighborKey(g, e));
+                }
+            }
+            radixSortUnique(next);
+            // neighbors of a level lie on the levels next to it
+            removeSorted(next, forward.back());
+            if (forward.size() > 1) {
+                removeSorted(next, forward[forward.size() - 2]);
+            }
+            heldKeys += next.size();
+            forward.push_back(std::move(next));
+        }
+        // backward: keep the states with a neighbor kept on the level after
+        size_t distance = forward.size() - 1;
+        dag.levels.resize(distance + 1);
+        dag.predecessors.resize(distance + 1);
+        dag.levels[distance] = {endKey};
+        for (size_t level = distance; level > 0; --level) {
+            std::vector<uint64_t> previous;
+            for (uint64_t key: dag.levels[level]) {
+                TriangulatedGraph g(FlipDistanceBfsSorted::unpack(key, dag.bits));
+                std::vector<Edge> edges = g.getEdges();
+                uint64_t mask = 0;
+                for (size_t i = 0; i < edges.size(); ++i) {
+                    uint64_t neighbor = neighborKey(g, edges[i]);
+                    if (std::binary_search(forward[level - 1].begin(), forward[level - 1].end(), neighbor)) {
+                        mask |= 1ull << i;
+                        previous.push_back(neighbor);
+                    }
+                }
+                dag.predecessors[level].push_back(mask);
+            }
+            forward[level] = {};
+            radixSortUnique(previous);
+            dag.levels[level - 1] = std::move(previous);
+        }
+        dag.predecessors[0] = {0};
+        return dag;
+    }
+
+    unsigned int distance() const {
+        return (unsigned int) levels.size() - 1;
+    }
+
+    // Number of states on some shortest path, start and end included.
+    size_t states() const {
+        size_t total = 0;
+        for (const auto &level: levels) {
+            total += level.size();
+        }
+        return total;
+    }
+
+    // Number of distinct shortest flip sequences, by summing the counts of the predecessors level by level.
+    BigUnsigned countPaths() const {
+        std::vector<BigUnsigned> counts{1};
+        for (int level = 1; level < (int) levels.size(); ++level) {
+            std::vector<BigUnsigned> next(levels[level].size());
+            for (size_t i = 0; i < levels[level].size(); ++i) {
+                TriangulatedGraph g(FlipDistanceBfsSorted::unpack(levels[level][i], bits));
+                std::vector<Edge> edges = g.getEdges();
+                for (uint64_t mask = predecessors[level][i]; mask != 0; mask &= mask - 1) {
+                    next[i] += counts[indexOf(level - 1, neighborKey(g, edges[__builtin_ctzll(mask)]))];
+                }
+            }
+            counts = std::move(next);
+        }
+        return counts[0];
+    }
+
+    // Yields the shortest paths one at a time by a depth first walk from end back to start, holding one
+    // frame per level: a path costs O(distance * n) memory however many there are.
+    class Enumerator {
+    private:
+        struct Frame {
+            std::vector<Edge> edges;
+            // diagonals of edges not tried yet
+            uint64_t remaining;
+            // diagonal created by the flip from the frame below, which undoes it
+            Edge created;
+        };
+
+        const ShortestPathDag &dag;
+        TriangulatedGraph g;
+        // frames[i] is on level distance - i
+        std::vector<Frame> frames;
+
+    public:
+        explicit Enumerator(const ShortestPathDag &dag) : dag(dag), g(dag.end) {
+            frames.push_back({g.getEdges(), dag.predecessors[dag.distance()][0], Edge()});
+        }
+
+        // Next path from start to end, or empty once every path was returned.
+        std::optional<std::vector<Edge>> next() {
+            while (!frames.empty()) {
+                Frame &top = frames.back();
+                int level = (int) dag.distance() - (int) frames.size() + 1;
+                if (level == 0 || top.remaining == 0) {
+                    std::optional<std::vector<Edge>> path;
+                    if (level == 0) {
+                        path.emplace();
+                        for (size_t i = frames.size() - 1; i > 0; --i) {
+                            path->push_back(frames[i].created);
+                        }
+                    }
+                    if (frames.size() > 1) {
+                        g.flip(top.created);
+                    }
+                    frames.pop_back();
+                    if (path) {
+                        return path;
+                    }
+                    continue;
+                }
+                Edge e = top.edges[__builtin_ctzll(top.remaining)];
+                top.remaining &= top.remaining - 1;
+                Edge created = g.flip(e);
+                uint64_t mask = dag.predecessorMask(level - 1, FlipDistanceBfsSorted::pack(g.toVector()));
+                frames.push_back({g.getEdges(), mask, created});
+            }
+            return std::nullopt;
+        }
+    };
+
+    // The enumerator refers to this DAG, which has to outlive it.
+    Enumerator paths() const {
+        return Enumerator(*this);
+    }
+};
+
+#endif //FLIPDISTANCE_SHORTEST_PATHS_H
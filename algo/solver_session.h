@@ -0,0 +1,165 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_SOLVER_SESSION_H
+#define FLIPDISTANCE_SOLVER_SESSION_H
+
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "flip_distance.h"
+#include "flip_distance_bounds.h"
+#include "registry.h"
+#include "special_instances.h"
+
+// Solver for a pair of triangulations edited a few flips at a time, as in interactive use. Every solve cuts the
+// instance along its common diagonals and takes the flips creating a diagonal of end, the same split structure
+// FlipDistanceSource::splitAndSearch exploits, and hands each remaining kernel to the engine. Exact kernel
+// results are cached by the kernel's own triangulations, so after an edit only the kernels containing changed
+// diagonals are searched again, and undoing an edit searches nothing.
+// Every flip moves the distance by at most one, so the previous result also bounds the new one: it keeps its
+// path, extended by the edits, as an upper bound when the search stops early.
+// Paths are only kept if the engine returns them for every kernel. The default BFS engine does; decision engines
+// such as the Source engine leave exact results without one, and so drop the path and its extension.
+class SolverSession {
+private:
+    const FlipDistanceFactory factory;
+    TriangulatedGraph start, end;
+    // result for the triangulations before the edits since, if there was a solve
+    std::optional<FlipDistanceResult> previous;
+    // flips from the current start to the previous one, and from the previous end to the current one
+    std::vector<Edge> startEdits, endEdits;
+    bool edited = true;
+    // exact kernel results by start and end bits of the kernel, with paths in the kernel's vertices
+    std::unordered_map<std::vector<bool>, FlipDistanceResult> kernels;
+    uint64_t kernelsSolved = 0, kernelsReused = 0;
+
+    static std::vector<bool> kernelKey(const InstancePiece &kernel) {
+        std::vector<bool> key = kernel.start.toVector(), endBits = kernel.end.toVector();
+        key.insert(key.end(), endBits.begin(), endBits.end());
+        return key;
+    }
+
+    static bool applyFlip(TriangulatedGraph &g, const Edge &e, Edge &created) {
+        if (!g.hasEdge(e) || !g.flippable(e)) {
+            return false;
+        }
+        created = g.flip(e);
+        return true;
+    }
+
+    FlipDistanceResult solveKernel(const InstancePiece &kernel, const SearchLimits &limits) {
+        std::vector<bool> key = kernelKey(kernel);
+        auto find = kernels.find(key);
+        if (find != kernels.end()) {
+            kernelsReused++;
+            return find->second;
+        }
+        kernelsSolved++;
+        FlipDistanceResult result = factory(kernel.start, kernel.end)->solve(limits);
+        if (result.exact) {
+            kernels.emplace(std::move(key), result);
+        }
+        return result;
+    }
+
+public:
+    explicit SolverSession(TriangulatedGraph start, TriangulatedGraph end,
+                           FlipDistanceFactory factory = makeEngine<FlipDistanceBfs>)
+            : factory(std::move(factory)), start(std::move(start)), end(std::move(end)) {}
+
+    const TriangulatedGraph &getStart() const {
+        return start;
+    }
+
+    const TriangulatedGraph &getEnd() const {
+        return end;
+    }
+
+    // Flips diagonal e of start; false, leaving start unchanged, if e is not a diagonal of it.
+    bool flipStart(const Edge &e) {
+        Edge created;
+        if (!applyFlip(start, e, created)) {
+            return false;
+        }
+        startEdits.insert(startEdits.begin(), created);
+        edited = true;
+        return true;
+    }
+
+    // Flips diagonal e of end; false, leaving end unchanged, if e is not a diagonal of it.
+    bool flipEnd(const Edge &e) {
+        Edge created;
+        if (!applyFlip(end, e, created)) {
+            return false;
+        }
+        endEdits.push_back(e);
+        edited = true;
+        return true;
+    }
+
+    // Bounds and a path for the current triangulations; without edits since the last exact solve, that result.
+    FlipDistanceResult solve(const SearchLimits &limits = SearchLimits::none()) {
+        if (!edited && previous && previous->exact) {
+            return *previous;
+        }
+        FlipDistanceResult result;
+        std::vector<InstancePiece> pieces = reduceToKernels(InstancePiece::whole(start, end), result.path);
+        result.lowerBound = result.upperBound = (unsigned int) result.path.size();
+        result.exact = true;
+        bool complete = true;
+        for (const InstancePiece &kernel: pieces) {
+            FlipDistanceResult part = solveKernel(kernel, limits);
+            result.lowerBound += part.lowerBound;
+            result.upperBound += part.upperBound;
+            for (const Edge &e: part.path) {
+                result.path.push_back(kernel.original(e));
+            }
+            complete = complete && part.path.size() == part.upperBound;
+            result.exact = result.exact && part.exact;
+            if (part.stopReason != StopReason::None) {
+                result.stopReason = part.stopReason;
+            }
+        }
+        if (!complete) {
+            result.path.clear();
+        }
+        if (previous) {
+            unsigned int edits = (unsigned int) (startEdits.size() + endEdits.size());
+            if (previous->lowerBound > edits) {
+                result.lowerBound = std::max(result.lowerBound, previous->lowerBound - edits);
+            }
+            unsigned int extended = previous->upperBound + edits;
+            if (previous->path.size() == previous->upperBound &&
+                (extended < result.upperBound || (extended == result.upperBound && !complete))) {
+                result.upperBound = extended;
+                result.path = startEdits;
+                result.path.insert(result.path.end(), previous->path.begin(), previous->path.end());
+                result.path.insert(result.path.end(), endEdits.begin(), endEdits.end());
+            }
+            result.exact = result.lowerBound == result.upperBound;
+        }
+        previous = result;
+        startEdits.clear();
+        endEdits.clear();
+        edited = false;
+        return result;
+    }
+
+    // Kernels searched by the engine, and kernels answered from the cache, over the session's solves.
+    uint64_t getKernelsSolved() const {
+        return kernelsSolved;
+    }
+
+    uint64_t getKernelsReused() const {
+        return kernelsReused;
+    }
+
+    void clearCache() {
+        kernels.clear();
+    }
+};
+
+#endif //FLIPDISTANCE_SOLVER_SESSION_H
@@ -0,0 +1,136 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_SOURCE_ORDERING_H
+#define FLIPDISTANCE_SOURCE_ORDERING_H
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "flip_distance_bounds.h"
+#include "../triangulation/TriangulatedGraph.h"
+
+// Order in which FlipDistanceSource tries source sets and the choices for each pair of candidate flips.
+// Only the time to the first solution depends on it: every order explores the same space.
+class SourceOrdering {
+public:
+    // choices of orderChoices
+    static constexpr int SKIP = -1, FIRST = 0, SECOND = 1;
+
+    virtual ~SourceOrdering() = default;
+
+    // Reorders the source sets of g before a decision.
+    virtual void orderSources(const TriangulatedGraph &g, const TriangulatedGraph &end,
+                              std::vector<std::vector<Edge>> &sources) {}
+
+    // Per pair of candidate flips in g, the order in which to skip it (SKIP) or flip its FIRST or SECOND
+    // diagonal. choices holds the default order on entry; g is left unchanged.
+    virtual void orderChoices(TriangulatedGraph &g, const TriangulatedGraph &end,
+                              const std::vector<std::pair<Edge, Edge>> &pairs,
+                              std::vector<std::array<int, 3>> &choices) {}
+
+    // Source set of g that led to a solution.
+    virtual void solved(const TriangulatedGraph &g, const std::vector<Edge> &source) {}
+
+    // Whether the same instance always gets its source sets in the same order, which resuming a decision
+    // at a checkpointed position relies on.
+    virtual bool stable() const {
+        return true;
+    }
+};
+
+struct OrderingWeights {
+    // per diagonal of end that a flip stops crossing
+    double progress = 1;
+    // per flip, to prefer larger (> 0) or smaller (< 0) source sets
+    double size = 0;
+    // per earlier solution whose source set contained the flipped diagonal
+    double history = 0;
+};
+
+// Scores a flip by the diagonals of end it brings within reach: the ones its removed diagonal crosses and its
+// created diagonal does not. The flips of a source set are independent, so a set scores the sum of its flips,
+// and skipping a pair scores 0. Higher scores go first; ties keep the order of generation.
+// With history weighted, the diagonals of top level solutions are remembered, which speeds up repeated
+// decisions on the same instance but makes the order unstable.
+class ScoredSourceOrdering : public SourceOrdering {
+private:
+    const OrderingWeights weights;
+    std::mutex mutex;
+    std::map<std::pair<int, int>, int> solutions;
+
+    double historyScore(const Edge &e) {
+        if (weights.history == 0) {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        auto find = solutions.find({e.first, e.second});
+        return find == solutions.end() ? 0 : weights.history * find->second;
+    }
+
+    double score(TriangulatedGraph &g, const std::vector<Edge> &endDiagonals, const Edge &e) {
+        Edge created = g.flip(e);
+        g.flip(created);
+        return weights.progress * (crossingCount(e, endDiagonals) - crossingCount(created, endDiagonals)) +
+               weights.size + historyScore(e);
+    }
+
+public:
+    explicit ScoredSourceOrdering(OrderingWeights weights = {}) : weights(weights) {}
+
+    bool stable() const override {
+        return weights.history == 0;
+    }
+
+    void orderSources(const TriangulatedGraph &g, const TriangulatedGraph &end,
+                      std::vector<std::vector<Edge>> &sources) override {
+        TriangulatedGraph h = g;
+        std::vector<Edge> endDiagonals = end.getEdges();
+        std::vector<std::pair<double, size_t>> scores;
+        for (size_t i = 0; i < sources.size(); ++i) {
+            double total = 0;
+            for (const Edge &e: sources[i]) {
+                total += score(h, endDiagonals, e);
+            }
+            scores.emplace_back(-total, i);
+        }
+        std::stable_sort(scores.begin(), scores.end(), [](const auto &a, const auto &b) {
+            return a.first < b.first;
+        });
+        std::vector<std::vector<Edge>> ordered;
+        ordered.reserve(sources.size());
+        for (const auto &entry: scores) {
+            ordered.push_back(std::move(sources[entry.second]));
+        }
+        sources = std::move(ordered);
+    }
+
+    void orderChoices(TriangulatedGraph &g, const TriangulatedGraph &end,
+                      const std::vector<std::pair<Edge, Edge>> &pairs,
+                      std::vector<std::array<int, 3>> &choices) override {
+        std::vector<Edge> endDiagonals = end.getEdges();
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            std::array<std::pair<double, int>, 3> scored{
+                    std::make_pair(0.0, SKIP),
+                    std::make_pair(g.flippable(pairs[i].first) ? score(g, endDiagonals, pairs[i].first) : 0, FIRST),
+                    std::make_pair(g.flippable(pairs[i].second) ? score(g, endDiagonals, pairs[i].second) : 0, SECOND)};
+            std::stable_sort(scored.begin(), scored.end(), [](const auto &a, const auto &b) {
+                return a.first > b.first;
+            });
+            choices[i] = {scored[0].second, scored[1].second, scored[2].second};
+        }
+    }
+
+    void solved(const TriangulatedGraph &g, const std::vector<Edge> &source) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const Edge &e: source) {
+            solutions[{e.first, e.second}]++;
+        }
+    }
+};
+
+#endif //FLIPDISTANCE_SOURCE_ORDERING_H
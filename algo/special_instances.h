@@ -0,0 +1,192 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_SPECIAL_INSTANCES_H
+#define FLIPDISTANCE_SPECIAL_INSTANCES_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include "flip_distance_bounds.h"
+#include "search_context.h"
+#include "../triangulation/TriangulatedGraph.h"
+
+// Part of an instance cut out along common diagonals.
+struct InstancePiece {
+    TriangulatedGraph start;
+    TriangulatedGraph end;
+    // vertex of the whole polygon for each vertex of the piece
+    std::vector<int> vertices;
+
+    static InstancePiece whole(const TriangulatedGraph &start, const TriangulatedGraph &end) {
+        std::vector<int> vertices(start.getSize());
+        std::iota(vertices.begin(), vertices.end(), 0);
+        return {start, end, std::move(vertices)};
+    }
+
+    Edge original(const Edge &e) const {
+        return {vertices[e.first], vertices[e.second]};
+    }
+
+    // Side from v1 to v2, as cut by TriangulatedGraph::subGraph.
+    InstancePiece side(int v1, int v2) const {
+        InstancePiece result{start.subGraph(v1, v2), end.subGraph(v1, v2), {}};
+        for (int i = 0; i < (int) result.start.getSize(); ++i) {
+            result.vertices.push_back(vertices[(v1 + i) % vertices.size()]);
+        }
+        return result;
+    }
+};
+
+// Vertices the flip of diagonal e of g would connect, i.e. the neighbors of e.first before and after e.second
+// in the order around the polygon. Takes O(log n), where TriangulatedGraph::flip takes O(n).
+inline Edge flippedDiagonal(const TriangulatedGraph &g, const Edge &e) {
+    const std::set<int> &neighbors = g.vertices[e.first].neighbors;
+    auto at = neighbors.lower_bound(e.second);
+    auto after = at != neighbors.end() && *at == e.second ? std::next(at) : at;
+    int before = at == neighbors.begin() ? *neighbors.rbegin() : *std::prev(at);
+    return {before, after == neighbors.end() ? *neighbors.begin() : *after};
+}
+
+// Takes every flip that creates a diagonal of end, none of which lengthens a shortest path (Sleator, Tarjan and
+// Thurston), and splits what is left along the common diagonals into kernels: pieces that allow no such flip
+// and share no diagonal with their end. Flips taken are appended to path in the vertices of the whole polygon.
+// Builds at most maxKernels + 1 kernels, enough to tell whether more than maxKernels are left.
+inline std::vector<InstancePiece> reduceToKernels(InstancePiece whole, std::vector<Edge> &path,
+                                                  size_t maxKernels = SIZE_MAX) {
+    TriangulatedGraph &g = whole.start;
+    const TriangulatedGraph &t = whole.end;
+    // a flip only changes the quadrilateral it happens in, so only the sides of that can become good flips
+    std::vector<Edge> candidates = g.getEdges();
+    while (!candidates.empty()) {
+        Edge e = candidates.back();
+        candidates.pop_back();
+        if (g.isSimpleEdge(e) || !g.hasEdge(e) || t.hasEdge(e)) {
+            continue;
+        }
+        Edge created = flippedDiagonal(g, e);
+        if (!t.hasEdge(created)) {
+            continue;
+        }
+        g.vertices[e.first].neighbors.erase(e.second);
+        g.vertices[e.second].neighbors.erase(e.first);
+        g.addEdge(created);
+        path.push_back(whole.original(e));
+        for (int v: {e.first, e.second}) {
+            candidates.emplace_back(v, created.first);
+            candidates.emplace_back(v, created.second);
+        }
+    }
+
+    // the diagonals left that are not common are those of kernels, and the diagonals of one kernel are
+    // connected through the triangles they share
+    size_t n = g.getSize();
+    std::vector<Edge> diagonals;
+    std::unordered_map<size_t, int> indexOf;
+    for (const Edge &e: g.getEdges()) {
+        if (!t.hasEdge(e)) {
+            indexOf[e.first * n + e.second] = (int) diagonals.size();
+            diagonals.push_back(e);
+        }
+    }
+    std::vector<int> parent(diagonals.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    std::function<int(int)> find = [&](int i) {
+        return parent[i] == i ? i : parent[i] = find(parent[i]);
+    };
+    auto indexOfEdge = [&](const Edge &e) {
+        auto it = indexOf.find(e.first * n + e.second);
+        return it == indexOf.end() ? -1 : it->second;
+    };
+    std::vector<Edge> apexes;
+    for (int i = 0; i < (int) diagonals.size(); ++i) {
+        const Edge &e = diagonals[i];
+        apexes.push_back(flippedDiagonal(g, e));
+        for (int v: {e.first, e.second}) {
+            for (int apex: {apexes.back().first, apexes.back().second}) {
+                int j = indexOfEdge(Edge(v, apex));
+                if (j >= 0) {
+                    parent[find(i)] = find(j);
+                }
+            }
+        }
+    }
+    std::vector<int> kernelOf(diagonals.size(), -1);
+    std::vector<std::vector<int>> vertices;
+    std::vector<std::vector<Edge>> startDiagonals, endDiagonals;
+    for (int i = 0; i < (int) diagonals.size(); ++i) {
+        int &kernel = kernelOf[find(i)];
+        if (kernel < 0) {
+            kernel = (int) vertices.size();
+            vertices.emplace_back();
+            startDiagonals.emplace_back();
+            endDiagonals.emplace_back();
+        }
+        kernelOf[i] = kernel;
+        for (int v: {diagonals[i].first, diagonals[i].second, apexes[i].first, apexes[i].second}) {
+            vertices[kernel].push_back(v);
+        }
+        startDiagonals[kernel].push_back(diagonals[i]);
+    }
+    // a diagonal of end but not of start crosses the far side of the triangle of start it leaves its first
+    // vertex through, which belongs to the same kernel
+    for (const Edge &f: t.getEdges()) {
+        if (!g.hasEdge(f)) {
+            endDiagonals[kernelOf[indexOfEdge(flippedDiagonal(g, f))]].push_back(f);
+        }
+    }
+    std::vector<InstancePiece> kernels;
+    for (size_t kernel = 0; kernel < vertices.size() && kernels.size() <= maxKernels; ++kernel) {
+        std::vector<int> &polygon = vertices[kernel];
+        std::sort(polygon.begin(), polygon.end());
+        polygon.erase(std::unique(polygon.begin(), polygon.end()), polygon.end());
+        auto local = [&](const Edge &e) {
+            return Edge(int(std::lower_bound(polygon.begin(), polygon.end(), e.first) - polygon.begin()),
+                        int(std::lower_bound(polygon.begin(), polygon.end(), e.second) - polygon.begin()));
+        };
+        InstancePiece piece{TriangulatedGraph(polygon.size()), TriangulatedGraph(polygon.size()), {}};
+        for (const Edge &e: startDiagonals[kernel]) {
+            piece.start.addEdge(local(e));
+        }
+        for (const Edge &e: endDiagonals[kernel]) {
+            piece.end.addEdge(local(e));
+        }
+        for (int v: polygon) {
+            piece.vertices.push_back(whole.vertices[v]);
+        }
+        kernels.push_back(std::move(piece));
+    }
+    return kernels;
+}
+
+// Exact distance and path of instances that need no search; empty for all others. Cheapest checks first:
+// equal triangulations, a fan path as short as the lower bound (e.g. whenever start or end is a fan, the
+// comb of rotation distance), and instances that reduce without leaving a kernel.
+inline std::optional<FlipDistanceResult> solveSpecialInstance(const TriangulatedGraph &s,
+                                                              const TriangulatedGraph &t) {
+    FlipDistanceResult result;
+    result.exact = true;
+    if (s == t) {
+        return result;
+    }
+    int v = bestFanVertex(s, t);
+    unsigned int lowerBound = flipDistanceLowerBound(s, t);
+    if (fanDistance(s, t, v) == lowerBound) {
+        result.lowerBound = result.upperBound = lowerBound;
+        result.path = fanPath(s, t, v);
+        return result;
+    }
+    if (!reduceToKernels(InstancePiece::whole(s, t), result.path, 0).empty()) {
+        return std::nullopt;
+    }
+    result.lowerBound = result.upperBound = (unsigned int) result.path.size();
+    return result;
+}
+
+#endif //FLIPDISTANCE_SPECIAL_INSTANCES_H
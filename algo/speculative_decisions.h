@@ -0,0 +1,167 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_SPECULATIVE_DECISIONS_H
+#define FLIPDISTANCE_SPECULATIVE_DECISIONS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+#include "flip_distance.h"
+#include "../utils/executor.h"
+
+// Computes the distance by deciding up to window consecutive k at once, each with its own solver from
+// factory. Decisions are monotone in k, so a true decision cancels every larger k and a false one every
+// smaller k; the window then slides up from the lowest k still open. The fan distance is never decided.
+// The bounds and path each decision proved are merged into the result, and a k its engine cannot settle without
+// being stopped is not decided again.
+// configure, if given, is called on every solver before its decision starts, e.g. to attach a profiler or a
+// tracer, and the statistics of every decision are added to statistics, if given.
+// Engines that decide by solving would repeat the same full solve for every k, so they solve once instead.
+// The decisions run on executor, so this must not be called from one of its own threads.
+inline FlipDistanceResult speculativeFlipDistance(const FlipDistanceFactory &factory, const TriangulatedGraph &start,
+                                                  const TriangulatedGraph &end, unsigned int window,
+                                                  const SolveRequest &request,
+                                                  Executor &executor = Executor::shared(),
+                                                  const std::function<void(FlipDistance &)> &configure = nullptr,
+                                                  StatisticsSnapshot *statistics = nullptr) {
+    struct Decision {
+        std::unique_ptr<FlipDistance> solver;
+        CancellationToken token;
+    };
+    struct Settled {
+        unsigned int k;
+        FlipDistanceResult result;
+        StatisticsSnapshot statistics;
+    };
+    // made up front to ask the engine, then used for the first decision
+    std::unique_ptr<FlipDistance> spare = factory(start, end);
+    if (spare->decidesBySolving()) {
+        if (configure) {
+            configure(*spare);
+        }
+        FlipDistanceResult solved = spare->solve(request.limits);
+        if (statistics != nullptr) {
+            statistics->add(spare->getStatistics());
+        }
+        if (request.onProgress) {
+            request.onProgress(solved);
+        }
+        return solved;
+    }
+    FlipDistanceResult result;
+    int v = bestFanVertex(start, end);
+    result.lowerBound = flipDistanceLowerBound(start, end);
+    result.upperBound = fanDistance(start, end, v);
+    result.path = fanPath(start, end, v);
+    window = std::max(window, 1u);
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::map<unsigned int, Decision> running;
+    // settled decisions not yet merged, and the number of tasks still referencing running
+    std::vector<Settled> settled;
+    size_t pending = 0;
+    // k the engine left open without being stopped
+    std::set<unsigned int> unsettled;
+    StopReason stopReason = StopReason::None;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (result.lowerBound < result.upperBound) {
+        for (auto k = result.lowerBound; k < result.upperBound && running.size() < window; ++k) {
+            if (running.count(k) > 0 || unsettled.count(k) > 0) {
+                continue;
+            }
+            Decision &decision = running[k];
+            decision.solver = spare ? std::move(spare) : factory(start, end);
+            if (configure) {
+                configure(*decision.solver);
+            }
+            SearchLimits limits = request.limits;
+            limits.cancellation = decision.token;
+            FlipDistance *solver = decision.solver.get();
+            pending++;
+            executor.submit([&, solver, limits, k]() {
+                FlipDistanceResult answer = solver->decideWithin(k, limits);
+                StatisticsSnapshot snapshot = solver->getStatistics();
+                std::lock_guard<std::mutex> guard(mutex);
+                settled.push_back({k, std::move(answer), std::move(snapshot)});
+                changed.notify_all();
+            });
+        }
+        if (running.empty() && settled.empty()) {
+            // every k left is one the engine cannot settle
+            break;
+        }
+        if (settled.empty()) {
+            if (request.limits.cancellation.cancelled()) {
+                stopReason = StopReason::Cancelled;
+                break;
+            }
+            // the timeout only bounds the latency of a cancellation by the caller
+            changed.wait_for(lock, std::chrono::milliseconds(10));
+            continue;
+        }
+        bool improved = false;
+        for (const Settled &entry: settled) {
+            pending--;
+            running.erase(entry.k);
+            if (statistics != nullptr) {
+                statistics->add(entry.statistics);
+            }
+            const FlipDistanceResult &decision = entry.result;
+            if (decision.lowerBound > result.lowerBound) {
+                result.lowerBound = decision.lowerBound;
+                improved = true;
+            }
+            if (decision.upperBound < result.upperBound) {
+                result.upperBound = decision.upperBound;
+                result.path = decision.path.size() == decision.upperBound ? decision.path : std::vector<Edge>();
+                improved = true;
+            }
+            // stopped by its own limits, unless it was cancelled below because it became pointless
+            if (!decision.decides(entry.k) && entry.k >= result.lowerBound && entry.k < result.upperBound) {
+                if (request.limits.cancellation.cancelled()) {
+                    stopReason = StopReason::Cancelled;
+                } else if (decision.stopReason != StopReason::None) {
+                    stopReason = decision.stopReason;
+                } else {
+                    unsettled.insert(entry.k);
+                }
+            }
+        }
+        settled.clear();
+        for (auto &entry: running) {
+            if (entry.first < result.lowerBound || entry.first >= result.upperBound) {
+                entry.second.token.cancel();
+            }
+        }
+        if (improved && request.onProgress) {
+            request.onProgress(result);
+        }
+        if (stopReason != StopReason::None) {
+            break;
+        }
+    }
+    for (auto &entry: running) {
+        entry.second.token.cancel();
+    }
+    // the tasks reference the locals above, so wait for every one of them
+    changed.wait(lock, [&]() { return settled.size() == pending; });
+    for (const Settled &entry: settled) {
+        if (statistics != nullptr) {
+            statistics->add(entry.statistics);
+        }
+    }
+    result.exact = result.lowerBound >= result.upperBound;
+    result.stopReason = result.exact ? StopReason::None : stopReason;
+    return result;
+}
+
+#endif //FLIPDISTANCE_SPECULATIVE_DECISIONS_H
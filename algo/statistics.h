@@ -0,0 +1,311 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_STATISTICS_H
+#define FLIPDISTANCE_STATISTICS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../config.h"
+#include "../utils/thread_slots.h"
+
+// Hot-path counters are only touched through FD_STAT, so building without FLIP_DISTANCE_STATISTICS
+// removes them from the search loops entirely.
+#ifdef FLIP_DISTANCE_STATISTICS
+#define FD_STAT(statement) statement
+#else
+#define FD_STAT(statement)
+#endif
+
+struct StatisticsSnapshot {
+    std::vector<uint64_t> nodesPerDepth;
+    std::vector<uint64_t> frontierSizes;
+    uint64_t flips = 0;
+    uint64_t splits = 0;
+    uint64_t sourceSetsTried = 0;
+    uint64_t cacheHits = 0;
+    uint64_t cacheMisses = 0;
+    // estimated peak bytes held by visited sets and frontiers
+    uint64_t visitedBytes = 0;
+    uint64_t frontierBytes = 0;
+    // switches from BFS to another engine, and the BFS level of the last one (-1 if none)
+    uint64_t fallbacks = 0;
+    int fallbackLevel = -1;
+    // (sub)instances answered by solveSpecialInstance without search
+    uint64_t specialInstances = 0;
+    // false positive rate an approximate visited filter was configured for, and the rate expected at its final
+    // fill (0 without a filter)
+    double filterFalsePositiveRate = 0;
+    double filterEstimatedRate = 0;
+
+    uint64_t nodesExpanded() const {
+        uint64_t total = 0;
+        for (uint64_t n: nodesPerDepth) {
+            total += n;
+        }
+        return total;
+    }
+
+    // Adds the counts of other, as StatisticsCounters::mergeInto does for the counters of each thread.
+    void add(const StatisticsSnapshot &other) {
+        auto addList = [](const std::vector<uint64_t> &source, std::vector<uint64_t> &target) {
+            target.resize(std::max(target.size(), source.size()));
+            for (size_t i = 0; i < source.size(); ++i) {
+                target[i] += source[i];
+            }
+        };
+        addList(other.nodesPerDepth, nodesPerDepth);
+        addList(other.frontierSizes, frontierSizes);
+        flips += other.flips;
+        splits += other.splits;
+        sourceSetsTried += other.sourceSetsTried;
+        cacheHits += other.cacheHits;
+        cacheMisses += other.cacheMisses;
+        visitedBytes += other.visitedBytes;
+        frontierBytes += other.frontierBytes;
+        fallbacks += other.fallbacks;
+        fallbackLevel = std::max(fallbackLevel, other.fallbackLevel);
+        specialInstances += other.specialInstances;
+        filterFalsePositiveRate = std::max(filterFalsePositiveRate, other.filterFalsePositiveRate);
+        filterEstimatedRate = std::max(filterEstimatedRate, other.filterEstimatedRate);
+    }
+
+    static std::string listToString(const std::vector<uint64_t> &list) {
+        std::string res;
+        for (uint64_t n: list) {
+            res += (res.empty() ? "" : ",") + std::to_string(n);
+        }
+        return "[" + res + "]";
+    }
+
+    static std::string rateToString(double rate) {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%.3g", rate);
+        return buffer;
+    }
+
+    // Single line of space separated key=value pairs.
+    std::string toString() const {
+        return "nodes=" + std::to_string(nodesExpanded()) +
+               " flips=" + std::to_string(flips) +
+               " splits=" + std::to_string(splits) +
+               " sources=" + std::to_string(sourceSetsTried) +
+               " cacheHits=" + std::to_string(cacheHits) +
+               " cacheMisses=" + std::to_string(cacheMisses) +
+               " visitedBytes=" + std::to_string(visitedBytes) +
+               " frontierBytes=" + std::to_string(frontierBytes) +
+               " fallbacks=" + std::to_string(fallbacks) +
+               " fallbackLevel=" + std::to_string(fallbackLevel) +
+               " special=" + std::to_string(specialInstances) +
+               " filterRate=" + rateToString(filterFalsePositiveRate) +
+               " filterEstimate=" + rateToString(filterEstimatedRate) +
+               " depth=" + listToString(nodesPerDepth) +
+               " frontier=" + listToString(frontierSizes);
+    }
+};
+
+// Counters per depth, allocated a chunk of depths at a time as the owning thread reaches them; searches rarely go
+// deeper than a few dozen levels. Chunks are published with release stores, so readers see zeros or the counts.
+class DepthCounters {
+public:
+    static const int MAX_DEPTH = 2 * MAX_VERTEX_COUNT;
+
+private:
+    static const int CHUNK = 64;
+    static const int CHUNKS = (MAX_DEPTH + CHUNK - 1) / CHUNK;
+
+    std::atomic<std::atomic<uint64_t> *> chunks[CHUNKS]{};
+
+public:
+    DepthCounters() = default;
+
+    DepthCounters(const DepthCounters &) = delete;
+
+    DepthCounters &operator=(const DepthCounters &) = delete;
+
+    ~DepthCounters() {
+        for (auto &chunk: chunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Only called by the owning thread.
+    std::atomic<uint64_t> &at(int depth) {
+        depth = std::min(std::max(depth, 0), MAX_DEPTH - 1);
+        std::atomic<uint64_t> *chunk = chunks[depth / CHUNK].load(std::memory_order_relaxed);
+        if (chunk == nullptr) {
+            chunk = new std::atomic<uint64_t>[CHUNK]{};
+            chunks[depth / CHUNK].store(chunk, std::memory_order_release);
+        }
+        return chunk[depth % CHUNK];
+    }
+
+    void mergeInto(std::vector<uint64_t> &target) const {
+        for (int c = 0; c < CHUNKS; ++c) {
+            const std::atomic<uint64_t> *chunk = chunks[c].load(std::memory_order_acquire);
+            for (int i = 0; chunk != nullptr && i < CHUNK; ++i) {
+                uint64_t n = chunk[i].load(std::memory_order_relaxed);
+                if (n > 0) {
+                    target.resize(std::max(target.size(), (size_t) (c * CHUNK + i) + 1));
+                    target[c * CHUNK + i] += n;
+                }
+            }
+        }
+    }
+
+    void reset() {
+        for (auto &chunk: chunks) {
+            std::atomic<uint64_t> *counters = chunk.load(std::memory_order_acquire);
+            for (int i = 0; counters != nullptr && i < CHUNK; ++i) {
+                counters[i].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+// Counters owned by a single thread. Only the owner writes, so relaxed load/store pairs are enough and
+// compile to plain increments; readers on other threads may see slightly stale values.
+class StatisticsCounters {
+public:
+    DepthCounters nodesPerDepth;
+    DepthCounters frontierSizes;
+    std::atomic<uint64_t> flips{0};
+    std::atomic<uint64_t> splits{0};
+    std::atomic<uint64_t> sourceSetsTried{0};
+    std::atomic<uint64_t> cacheHits{0};
+    std::atomic<uint64_t> cacheMisses{0};
+    std::atomic<uint64_t> peakVisitedBytes{0};
+    std::atomic<uint64_t> peakFrontierBytes{0};
+    std::atomic<uint64_t> fallbacks{0};
+    // level + 1, so that 0 means none
+    std::atomic<uint64_t> fallbackLevel{0};
+    std::atomic<uint64_t> specialInstances{0};
+    // bit patterns of the doubles
+    std::atomic<uint64_t> filterRate{0};
+    std::atomic<uint64_t> filterEstimate{0};
+
+    static inline void add(std::atomic<uint64_t> &counter, uint64_t n = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void expand(int depth, uint64_t n = 1) {
+        add(nodesPerDepth.at(depth), n);
+    }
+
+    void frontier(int level, uint64_t size) {
+        add(frontierSizes.at(level), size);
+    }
+
+    void flip(uint64_t n = 1) {
+        add(flips, n);
+    }
+
+    void split() {
+        add(splits);
+    }
+
+    void sourceSet() {
+        add(sourceSetsTried);
+    }
+
+    void cacheLookup(bool hit, uint64_t n = 1) {
+        add(hit ? cacheHits : cacheMisses, n);
+    }
+
+    void memory(uint64_t visitedBytes, uint64_t frontierBytes) {
+        if (visitedBytes > peakVisitedBytes.load(std::memory_order_relaxed)) {
+            peakVisitedBytes.store(visitedBytes, std::memory_order_relaxed);
+        }
+        if (frontierBytes > peakFrontierBytes.load(std::memory_order_relaxed)) {
+            peakFrontierBytes.store(frontierBytes, std::memory_order_relaxed);
+        }
+    }
+
+    void fallback(int level) {
+        add(fallbacks);
+        fallbackLevel.store((uint64_t) level + 1, std::memory_order_relaxed);
+    }
+
+    void special() {
+        add(specialInstances);
+    }
+
+    static uint64_t toBits(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    static double fromBits(uint64_t bits) {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    void filter(double configuredRate, double estimatedRate) {
+        filterRate.store(toBits(configuredRate), std::memory_order_relaxed);
+        filterEstimate.store(toBits(estimatedRate), std::memory_order_relaxed);
+    }
+
+    void mergeInto(StatisticsSnapshot &snapshot) const {
+        nodesPerDepth.mergeInto(snapshot.nodesPerDepth);
+        frontierSizes.mergeInto(snapshot.frontierSizes);
+        snapshot.flips += flips.load(std::memory_order_relaxed);
+        snapshot.splits += splits.load(std::memory_order_relaxed);
+        snapshot.sourceSetsTried += sourceSetsTried.load(std::memory_order_relaxed);
+        snapshot.cacheHits += cacheHits.load(std::memory_order_relaxed);
+        snapshot.cacheMisses += cacheMisses.load(std::memory_order_relaxed);
+        snapshot.visitedBytes += peakVisitedBytes.load(std::memory_order_relaxed);
+        snapshot.frontierBytes += peakFrontierBytes.load(std::memory_order_relaxed);
+        snapshot.fallbacks += fallbacks.load(std::memory_order_relaxed);
+        snapshot.fallbackLevel = std::max(snapshot.fallbackLevel,
+                                          (int) fallbackLevel.load(std::memory_order_relaxed) - 1);
+        snapshot.specialInstances += specialInstances.load(std::memory_order_relaxed);
+        snapshot.filterFalsePositiveRate = std::max(snapshot.filterFalsePositiveRate,
+                                                    fromBits(filterRate.load(std::memory_order_relaxed)));
+        snapshot.filterEstimatedRate = std::max(snapshot.filterEstimatedRate,
+                                                fromBits(filterEstimate.load(std::memory_order_relaxed)));
+    }
+
+    void reset() {
+        nodesPerDepth.reset();
+        frontierSizes.reset();
+        for (auto *counter: {&flips, &splits, &sourceSetsTried, &cacheHits, &cacheMisses,
+                             &peakVisitedBytes, &peakFrontierBytes, &fallbacks, &fallbackLevel,
+                             &specialInstances, &filterRate, &filterEstimate}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Statistics of one solver (and the sub-solvers it spawns). Every thread gets its own counters,
+// which are merged when a snapshot is taken.
+class Statistics {
+private:
+    ThreadSlots<StatisticsCounters> counters;
+
+public:
+    StatisticsCounters &local() {
+        return counters.local();
+    }
+
+    StatisticsSnapshot snapshot() const {
+        StatisticsSnapshot result;
+        counters.forEach([&](const StatisticsCounters &c) { c.mergeInto(result); });
+        return result;
+    }
+
+    // Not synchronized with running searches; call between solves.
+    void reset() {
+        counters.forEach([](StatisticsCounters &c) { c.reset(); });
+    }
+};
+
+#endif //FLIPDISTANCE_STATISTICS_H
@@ -0,0 +1,387 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <map>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "benchmark.h"
+#include "corpus.h"
+#include "../algo/cost_model.h"
+#include "../algo/registry.h"
+#include "../triangulation/Helper.h"
+
+struct RunOptions {
+    std::string corpus = "benchmarks/corpus/v1.txt";
+    std::string data = "data.txt";
+    std::vector<std::string> engines;
+    std::string filter;
+    std::string out;
+    // optional cost model; instances are then run longest predicted first
+    std::string model;
+    int repetitions = 5;
+    unsigned int timeout = 10;
+};
+
+TriangulatedGraph parseTree(const std::string &tree) {
+    return TriangulatedGraph(BinaryString(treeStringToParentheses(tree)).getBits());
+}
+
+// Runs one solve in a forked child so that a timeout can kill it and its peak RSS is measured in isolation.
+RunRecord runOnce(const CorpusInstance &instance, const std::string &engine, int repetition, unsigned int timeout) {
+    RunRecord record{instance.id, instance.n, instance.band, engine, repetition, "error"};
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return record;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        alarm(timeout);
+        auto algo = makeFlipDistance(engine, parseTree(instance.start), parseTree(instance.end));
+        auto begin = std::chrono::steady_clock::now();
+        unsigned int distance = algo->flipDistance();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        dprintf(fds[1], "%u %.9f %llu\n", distance, seconds,
+                (unsigned long long) algo->getStatistics().nodesExpanded());
+        _exit(0);
+    }
+    close(fds[1]);
+    char buffer[128] = {};
+    size_t length = 0;
+    ssize_t got;
+    while (length < sizeof(buffer) - 1 && (got = read(fds[0], buffer + length, sizeof(buffer) - 1 - length)) > 0) {
+        length += got;
+    }
+    close(fds[0]);
+    int status = 0;
+    rusage usage{};
+    wait4(pid, &status, 0, &usage);
+    record.peakRssKb = usage.ru_maxrss;
+    if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) {
+        record.status = "timeout";
+        record.seconds = timeout;
+        return record;
+    }
+    unsigned long long nodes = 0;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+        sscanf(buffer, "%lld %lf %llu", &record.distance, &record.seconds, &nodes) == 3) {
+        record.status = "ok";
+        record.nodes = nodes;
+    }
+    return record;
+}
+
+std::vector<CorpusInstance> loadInstances(const std::string &corpus, const std::string &dataFile) {
+    std::vector<CorpusInstance> instances = loadCorpus(corpus);
+    if (!dataFile.empty()) {
+        auto data = loadDataFile(dataFile);
+        instances.insert(instances.end(), data.begin(), data.end());
+    }
+    return instances;
+}
+
+int run(const RunOptions &options) {
+    std::vector<CorpusInstance> instances = loadInstances(options.corpus, options.data);
+    if (instances.empty()) {
+        fprintf(stderr, "No instances found in %s.\n", options.corpus.c_str());
+        return 1;
+    }
+    if (!options.model.empty()) {
+        CostModel model;
+        if (!model.load(options.model)) {
+            fprintf(stderr, "Could not read cost model %s.\n", options.model.c_str());
+            return 1;
+        }
+        std::vector<std::pair<double, CorpusInstance>> predicted;
+        for (const auto &instance: instances) {
+            InstanceFeatures features = extractFeatures(parseTree(instance.start), parseTree(instance.end));
+            double seconds = 0;
+            for (const auto &engine: options.engines) {
+                seconds += model.predict(features, engine);
+            }
+            predicted.emplace_back(seconds, instance);
+        }
+        std::stable_sort(predicted.begin(), predicted.end(), [](const auto &a, const auto &b) {
+            return a.first > b.first;
+        });
+        instances.clear();
+        for (const auto &entry: predicted) {
+            instances.push_back(entry.second);
+        }
+    }
+    FILE *out = options.out.empty() ? stdout : fopen(options.out.c_str(), "w");
+    if (out == nullptr) {
+        fprintf(stderr, "Could not open %s.\n", options.out.c_str());
+        return 1;
+    }
+    fprintf(out, "%s\n", REPORT_HEADER);
+    int wrongAnswers = 0;
+    for (const auto &instance: instances) {
+        if (instance.id.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        for (const auto &engine: options.engines) {
+            for (int rep = 0; rep < options.repetitions; ++rep) {
+                RunRecord record = runOnce(instance, engine, rep, options.timeout);
+                writeRecord(out, record);
+                fflush(out);
+                if (record.status == "ok" && instance.distance >= 0 && record.distance != instance.distance) {
+                    fprintf(stderr, "%s: %s returned %lld, expected %d.\n", instance.id.c_str(), engine.c_str(),
+                            record.distance, instance.distance);
+                    wrongAnswers++;
+                }
+                // a timed out engine will time out again
+                if (record.status == "timeout") {
+                    break;
+                }
+            }
+        }
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    return wrongAnswers > 0;
+}
+
+// Two-sided p-value of the Mann-Whitney U test. Exact for small samples without ties,
+// normal approximation otherwise.
+double mannWhitneyP(const std::vector<double> &a, const std::vector<double> &b) {
+    size_t m = a.size(), n = b.size();
+    if (m == 0 || n == 0) {
+        return 1;
+    }
+    double u = 0;
+    bool ties = false;
+    for (double x: a) {
+        for (double y: b) {
+            u += x < y ? 1 : (x == y ? 0.5 : 0);
+            ties |= x == y;
+        }
+    }
+    if (!ties && m <= 20 && n <= 20) {
+        // ways[i][j][k]: orderings of i values of a and j values of b with k pairs (a < b)
+        std::vector<std::vector<std::vector<double>>> ways(m + 1, std::vector<std::vector<double>>(
+                n + 1, std::vector<double>(m * n + 1, 0)));
+        for (size_t i = 0; i <= m; ++i) {
+            for (size_t j = 0; j <= n; ++j) {
+                for (size_t k = 0; k <= i * j; ++k) {
+                    if (i == 0 || j == 0) {
+                        ways[i][j][k] = k == 0;
+                        continue;
+                    }
+                    // the largest value either belongs to a (below no b) or to b (above all i values of a)
+                    ways[i][j][k] = ways[i - 1][j][k] + (k >= i ? ways[i][j - 1][k - i] : 0);
+                }
+            }
+        }
+        double total = 0, lower = 0, upper = 0;
+        for (size_t k = 0; k <= m * n; ++k) {
+            total += ways[m][n][k];
+            lower += k <= u ? ways[m][n][k] : 0;
+            upper += k >= u ? ways[m][n][k] : 0;
+        }
+        return std::min(1.0, 2 * std::min(lower, upper) / total);
+    }
+    double mean = (double) (m * n) / 2, sd = std::sqrt((double) (m * n * (m + n + 1)) / 12);
+    double z = (std::fabs(u - mean) - 0.5) / sd;
+    return std::min(1.0, std::erfc(std::max(z, 0.0) / std::sqrt(2.0)));
+}
+
+// Flags (instance, engine) pairs whose time got significantly worse, whose answer changed or that
+// stopped finishing in time.
+int compare(const std::string &basePath, const std::string &newPath, double alpha, double threshold) {
+    typedef std::pair<std::string, std::string> Key;
+    std::map<Key, std::vector<RunRecord>> base, current;
+    for (const auto &r: readReport(basePath)) {
+        base[{r.instance, r.engine}].push_back(r);
+    }
+    for (const auto &r: readReport(newPath)) {
+        current[{r.instance, r.engine}].push_back(r);
+    }
+    int regressions = 0, improvements = 0, compared = 0;
+    printf("%-14s %-10s %12s %12s %8s %10s  %s\n", "instance", "engine", "base(s)", "new(s)", "ratio", "p", "verdict");
+    for (const auto &entry: current) {
+        auto find = base.find(entry.first);
+        if (find == base.end()) {
+            continue;
+        }
+        compared++;
+        std::vector<double> before, after;
+        const RunRecord *solvedBefore = nullptr, *solvedAfter = nullptr;
+        for (const auto &r: find->second) {
+            before.push_back(r.seconds);
+            solvedBefore = r.status == "ok" ? &r : solvedBefore;
+        }
+        for (const auto &r: entry.second) {
+            after.push_back(r.seconds);
+            solvedAfter = r.status == "ok" ? &r : solvedAfter;
+        }
+        std::string verdict;
+        if (solvedBefore != nullptr && solvedAfter == nullptr) {
+            verdict = "no longer solved (" + entry.second.back().status + ")";
+        } else if (solvedBefore != nullptr && solvedBefore->distance != solvedAfter->distance) {
+            verdict = "distance changed";
+        }
+        double medianBefore = median(before), medianAfter = median(after);
+        double ratio = medianBefore > 0 ? medianAfter / medianBefore : 1;
+        double p = mannWhitneyP(before, after);
+        if (verdict.empty() && p < alpha && ratio > 1 + threshold) {
+            verdict = "slower";
+        }
+        if (!verdict.empty()) {
+            regressions++;
+        } else if (p < alpha && ratio < 1 - threshold) {
+            verdict = "faster";
+            improvements++;
+        }
+        if (!verdict.empty()) {
+            printf("%-14s %-10s %12.4f %12.4f %8.3f %10.4f  %s\n", entry.first.first.c_str(),
+                   entry.first.second.c_str(), medianBefore, medianAfter, ratio, p, verdict.c_str());
+        }
+    }
+    printf("%d compared, %d regressions, %d improvements (alpha %.3f, threshold %.0f%%)\n",
+           compared, regressions, improvements, alpha, threshold * 100);
+    return regressions > 0;
+}
+
+// Fits a cost model to the solved and timed out runs of exact engines in the given reports. Timeouts enter with
+// the timeout as their time, which underestimates them.
+int train(const std::vector<std::string> &reports, const std::string &corpus, const std::string &dataFile,
+          const std::string &modelPath) {
+    std::map<std::string, InstanceFeatures> features;
+    for (const auto &instance: loadInstances(corpus, dataFile)) {
+        features[instance.id] = extractFeatures(parseTree(instance.start), parseTree(instance.end));
+    }
+    std::vector<CostSample> samples;
+    for (const auto &report: reports) {
+        for (const auto &r: readReport(report)) {
+            auto find = features.find(r.instance);
+            if (find != features.end() && (r.status == "ok" || r.status == "timeout") &&
+                !isApproximationEngine(r.engine)) {
+                samples.push_back({find->second, r.engine, r.seconds});
+            }
+        }
+    }
+    if (samples.empty()) {
+        fprintf(stderr, "No runs of known instances found.\n");
+        return 1;
+    }
+    CostModel model;
+    model.fit(samples);
+    if (!model.save(modelPath)) {
+        fprintf(stderr, "Could not write %s.\n", modelPath.c_str());
+        return 1;
+    }
+    printf("%zu runs, engines:", samples.size());
+    for (const auto &engine: model.engines()) {
+        printf(" %s", engine.c_str());
+    }
+    printf("\n");
+    return 0;
+}
+
+int usage() {
+    printf("Usage: SolverBenchmark run [--corpus=file] [--data=file|--no-data] [--engines=a,b] [--filter=id]\n"
+           "                           [--repetitions=R] [--timeout=seconds] [--out=report.csv]\n"
+           "                           [--model=model.txt]\n"
+           "       SolverBenchmark compare base.csv new.csv [--alpha=0.05] [--threshold=0.05]\n"
+           "       SolverBenchmark train report.csv... [--corpus=file] [--data=file|--no-data] [--model=model.txt]\n");
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        return usage();
+    }
+    if (strcmp(argv[1], "compare") == 0) {
+        if (argc < 4) {
+            return usage();
+        }
+        double alpha = 0.05, threshold = 0.05;
+        for (int i = 4; i < argc; ++i) {
+            if (strncmp(argv[i], "--alpha=", 8) == 0) {
+                alpha = std::stod(argv[i] + 8);
+            } else if (strncmp(argv[i], "--threshold=", 12) == 0) {
+                threshold = std::stod(argv[i] + 12);
+            } else {
+                return usage();
+            }
+        }
+        return compare(argv[2], argv[3], alpha, threshold);
+    }
+    if (strcmp(argv[1], "train") == 0) {
+        std::vector<std::string> reports;
+        std::string corpus = "benchmarks/corpus/v1.txt", data = "data.txt", model = "cost_model.txt";
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("--corpus=", 0) == 0) {
+                corpus = arg.substr(9);
+            } else if (arg.rfind("--data=", 0) == 0) {
+                data = arg.substr(7);
+            } else if (arg == "--no-data") {
+                data.clear();
+            } else if (arg.rfind("--model=", 0) == 0) {
+                model = arg.substr(8);
+            } else if (arg.rfind("--", 0) == 0) {
+                return usage();
+            } else {
+                reports.push_back(arg);
+            }
+        }
+        if (reports.empty()) {
+            return usage();
+        }
+        return train(reports, corpus, data, model);
+    }
+    if (strcmp(argv[1], "run") != 0) {
+        return usage();
+    }
+    RunOptions options;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--corpus=", 0) == 0) {
+            options.corpus = arg.substr(9);
+        } else if (arg.rfind("--data=", 0) == 0) {
+            options.data = arg.substr(7);
+        } else if (arg == "--no-data") {
+            options.data.clear();
+        } else if (arg.rfind("--engines=", 0) == 0) {
+            std::istringstream stream(arg.substr(10));
+            std::string engine;
+            while (std::getline(stream, engine, ',')) {
+                options.engines.push_back(engine);
+            }
+        } else if (arg.rfind("--filter=", 0) == 0) {
+            options.filter = arg.substr(9);
+        } else if (arg.rfind("--repetitions=", 0) == 0) {
+            options.repetitions = std::stoi(arg.substr(14));
+        } else if (arg.rfind("--timeout=", 0) == 0) {
+            options.timeout = std::stoul(arg.substr(10));
+        } else if (arg.rfind("--out=", 0) == 0) {
+            options.out = arg.substr(6);
+        } else if (arg.rfind("--model=", 0) == 0) {
+            options.model = arg.substr(8);
+        } else {
+            return usage();
+        }
+    }
+    if (options.engines.empty()) {
+        for (const auto &engine: flipDistanceEngines()) {
+            options.engines.push_back(engine.first);
+        }
+    }
+    for (const auto &engine: options.engines) {
+        // the wrong answer check compares distances, which only exact engines guarantee
+        if (findExactEngine(engine) == nullptr) {
+            fprintf(stderr, "No exact engine named %s found.\n", engine.c_str());
+            return 1;
+        }
+    }
+    return run(options);
+}
@@ -0,0 +1,116 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include "benchmark.h"
+#include "../triangulation/Helper.h"
+#include "../utils/rand.h"
+
+// getSources enumerates independent sets and grows exponentially in n
+const int MAX_SOURCES_N = 20;
+
+struct Fixture {
+    TriangulatedGraph g;
+    TriangulatedGraph other;
+    std::vector<Edge> edges;
+    std::vector<bool> bits;
+    std::string tree;
+    std::vector<std::pair<int, int>> vertexPairs;
+
+    explicit Fixture(int n) : g(n), other(n) {
+        auto p = randomTriangulation(n, false);
+        g = p.first;
+        other = p.second;
+        edges = g.getEdges();
+        bits = g.toVector();
+        tree = binaryStringToTreeRep(bits);
+        std::uniform_int_distribution<int> vertex(0, n - 1);
+        for (int i = 0; i < 256; ++i) {
+            vertexPairs.emplace_back(vertex(randomEngine()), vertex(randomEngine()));
+        }
+    }
+};
+
+std::vector<BenchmarkResult> runAll(int n, const BenchmarkConfig &config, const std::string &filter) {
+    Fixture f(n);
+    std::vector<BenchmarkResult> results;
+    size_t i = 0;
+    auto nextEdge = [&]() -> const Edge & {
+        return f.edges[i++ % f.edges.size()];
+    };
+    auto add = [&](const std::string &name, const std::function<void()> &op, uint64_t opsPerCall = 1) {
+        if (name.find(filter) != std::string::npos) {
+            results.push_back(runBenchmark(name, n, config, op, opsPerCall));
+        }
+    };
+    TriangulatedGraph copy = f.g;
+    // flipping twice restores the graph, so the fixture stays valid
+    add("flip", [&]() {
+        Edge result = f.g.flip(nextEdge());
+        doNotOptimize(f.g.flip(result));
+    }, 2);
+    add("flippable", [&]() { doNotOptimize(f.g.flippable(nextEdge())); });
+    add("getNeighbors", [&]() { doNotOptimize(f.g.getNeighbors(nextEdge())); });
+    add("getEdges", [&]() { doNotOptimize(f.g.getEdges()); });
+    add("hasEdge", [&]() {
+        const auto &p = f.vertexPairs[i++ % f.vertexPairs.size()];
+        doNotOptimize(p.first != p.second && f.g.hasEdge(p.first, p.second));
+    });
+    add("operator==", [&]() { doNotOptimize(f.g == copy); });
+    add("toVector", [&]() { doNotOptimize(f.g.toVector()); });
+    add("TriangulatedGraph(bits)", [&]() { doNotOptimize(TriangulatedGraph(f.bits)); });
+    add("subGraph", [&]() {
+        const Edge &e = nextEdge();
+        doNotOptimize(f.g.subGraph(e.first, e.second));
+    });
+    if (n <= MAX_SOURCES_N) {
+        add("getSources", [&]() { doNotOptimize(f.g.getSources()); });
+    }
+    add("treeStringToParentheses", [&]() {
+        doNotOptimize(BinaryString(treeStringToParentheses(f.tree)).getBits());
+    });
+    return results;
+}
+
+// Microbenchmarks of the triangulation primitives, parameterised over the polygon size.
+int main(int argc, char **argv) {
+    BenchmarkConfig config;
+    std::vector<int> sizes = {8, 12, 16, 24, 32, 64, 128};
+    std::string filter, format = "csv";
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--n=", 4) == 0) {
+            sizes.clear();
+            std::stringstream stream(argv[i] + 4);
+            std::string item;
+            while (std::getline(stream, item, ',')) {
+                sizes.push_back(std::stoi(item));
+            }
+        } else if (strncmp(argv[i], "--filter=", 9) == 0) {
+            filter = argv[i] + 9;
+        } else if (strncmp(argv[i], "--repetitions=", 14) == 0) {
+            config.repetitions = std::stoi(argv[i] + 14);
+        } else if (strncmp(argv[i], "--min-ms=", 9) == 0) {
+            config.minRepetitionNs = std::stod(argv[i] + 9) * 1e6;
+        } else if (strcmp(argv[i], "--json") == 0) {
+            format = "json";
+        } else {
+            printf("Usage: Microbenchmarks [--n=8,16,...] [--filter=name] [--repetitions=R] [--min-ms=T] [--json]\n");
+            return 1;
+        }
+    }
+    seedRandom(1);
+    std::vector<BenchmarkResult> results;
+    for (int n: sizes) {
+        auto r = runAll(n, config, filter);
+        results.insert(results.end(), r.begin(), r.end());
+    }
+    if (format == "json") {
+        printJson(results);
+    } else {
+        printCsv(results);
+    }
+    return 0;
+}
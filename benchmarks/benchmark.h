@@ -0,0 +1,95 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_BENCHMARK_H
+#define FLIPDISTANCE_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Keeps the compiler from optimizing away a computed value.
+template<class T>
+inline void doNotOptimize(const T &value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct BenchmarkConfig {
+    int warmupRepetitions = 3;
+    int repetitions = 15;
+    // every repetition runs the operation in a batch at least this long
+    double minRepetitionNs = 2e6;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    int n;
+    double medianNs;
+    // median absolute deviation of the per-repetition ns/op
+    double madNs;
+    int repetitions;
+    uint64_t opsPerRepetition;
+};
+
+inline double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+}
+
+// Times op, which performs opsPerCall operations per call. The batch size is doubled until one batch
+// takes minRepetitionNs, then warm-up batches are discarded and each repetition yields one ns/op sample.
+template<class F>
+BenchmarkResult runBenchmark(const std::string &name, int n, const BenchmarkConfig &config, F &&op,
+                             uint64_t opsPerCall = 1) {
+    auto timeBatch = [&](uint64_t calls) {
+        auto begin = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < calls; ++i) {
+            op();
+        }
+        return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - begin).count();
+    };
+    uint64_t calls = 1;
+    while (timeBatch(calls) < config.minRepetitionNs && calls < (1ull << 40)) {
+        calls *= 2;
+    }
+    for (int i = 0; i < config.warmupRepetitions; ++i) {
+        timeBatch(calls);
+    }
+    std::vector<double> samples;
+    for (int i = 0; i < config.repetitions; ++i) {
+        samples.push_back(timeBatch(calls) / (double) (calls * opsPerCall));
+    }
+    double med = median(samples);
+    std::vector<double> deviations;
+    for (double sample: samples) {
+        deviations.push_back(sample < med ? med - sample : sample - med);
+    }
+    return {name, n, med, median(deviations), config.repetitions, calls * opsPerCall};
+}
+
+inline void printCsv(const std::vector<BenchmarkResult> &results) {
+    printf("name,n,median_ns,mad_ns,repetitions,ops_per_repetition\n");
+    for (const auto &r: results) {
+        printf("%s,%d,%.2f,%.2f,%d,%llu\n", r.name.c_str(), r.n, r.medianNs, r.madNs, r.repetitions,
+               (unsigned long long) r.opsPerRepetition);
+    }
+}
+
+inline void printJson(const std::vector<BenchmarkResult> &results) {
+    printf("[");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto &r = results[i];
+        printf("%s\n{\"name\":\"%s\",\"n\":%d,\"median_ns\":%.2f,\"mad_ns\":%.2f,\"repetitions\":%d,"
+               "\"ops_per_repetition\":%llu}", i ? "," : "", r.name.c_str(), r.n, r.medianNs, r.madNs,
+               r.repetitions, (unsigned long long) r.opsPerRepetition);
+    }
+    printf("\n]\n");
+}
+
+#endif //FLIPDISTANCE_BENCHMARK_H
@@ -0,0 +1,128 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_CORPUS_H
+#define FLIPDISTANCE_CORPUS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct CorpusInstance {
+    std::string id;
+    int n;
+    std::string band;
+    std::string start;
+    std::string end;
+    // -1 if not known in advance
+    int distance;
+};
+
+inline bool isTreeString(const std::string &s) {
+    return !s.empty() && s.find_first_not_of("a()") == std::string::npos;
+}
+
+// Versioned corpus file: "<id> <n> <band> <start> <end> <distance>" per line, '#' starts a comment.
+inline std::vector<CorpusInstance> loadCorpus(const std::string &path) {
+    std::vector<CorpusInstance> result;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream stream(line);
+        CorpusInstance instance;
+        if (stream >> instance.id >> instance.n >> instance.band >> instance.start >> instance.end
+                   >> instance.distance) {
+            result.push_back(instance);
+        }
+    }
+    return result;
+}
+
+// data.txt: pairs of tree strings on one line, optionally preceded by a "<n>gon FD: <d>" caption.
+inline std::vector<CorpusInstance> loadDataFile(const std::string &path) {
+    std::vector<CorpusInstance> result;
+    std::ifstream in(path);
+    std::string line;
+    int lineNumber = 0, distance = -1;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        std::istringstream stream(line);
+        std::string first, second, rest;
+        stream >> first >> second;
+        if (isTreeString(first) && isTreeString(second) && !(stream >> rest)) {
+            // a tree string has one leaf 'a' per polygon edge except the root edge
+            int n = 1;
+            for (char c: first) {
+                n += c == 'a';
+            }
+            result.push_back({"data-" + std::to_string(lineNumber), n, "data", first, second, distance});
+            distance = -1;
+        } else {
+            size_t fd = line.find("FD:");
+            distance = fd == std::string::npos ? -1 : std::stoi(line.substr(fd + 3));
+        }
+    }
+    return result;
+}
+
+struct RunRecord {
+    std::string instance;
+    int n = 0;
+    std::string band;
+    std::string engine;
+    int repetition = 0;
+    // ok, timeout or error
+    std::string status;
+    long long distance = -1;
+    double seconds = 0;
+    uint64_t nodes = 0;
+    uint64_t peakRssKb = 0;
+};
+
+inline const char *REPORT_HEADER = "instance,n,band,engine,repetition,status,distance,seconds,nodes,peak_rss_kb";
+
+inline void writeRecord(FILE *f, const RunRecord &r) {
+    fprintf(f, "%s,%d,%s,%s,%d,%s,%lld,%.6f,%llu,%llu\n", r.instance.c_str(), r.n, r.band.c_str(),
+            r.engine.c_str(), r.repetition, r.status.c_str(), r.distance, r.seconds,
+            (unsigned long long) r.nodes, (unsigned long long) r.peakRssKb);
+}
+
+inline std::vector<RunRecord> readReport(const std::string &path) {
+    std::vector<RunRecord> result;
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        std::istringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 10) {
+            continue;
+        }
+        RunRecord r;
+        r.instance = fields[0];
+        r.n = std::stoi(fields[1]);
+        r.band = fields[2];
+        r.engine = fields[3];
+        r.repetition = std::stoi(fields[4]);
+        r.status = fields[5];
+        r.distance = std::stoll(fields[6]);
+        r.seconds = std::stod(fields[7]);
+        r.nodes = std::stoull(fields[8]);
+        r.peakRssKb = std::stoull(fields[9]);
+        result.push_back(r);
+    }
+    return result;
+}
+
+#endif //FLIPDISTANCE_CORPUS_H
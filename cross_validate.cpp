@@ -0,0 +1,207 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "algo/registry.h"
+#include "triangulation/Helper.h"
+#include "utils/rand.h"
+
+struct Options {
+    int minN = 6, maxN = 10;
+    long long count = 1000;
+    unsigned int seed = 1;
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> engines;
+    bool decisions = true;
+};
+
+struct Answers {
+    std::vector<unsigned int> distances;
+    // per engine: decision(d - 1) and decision(d) for the reference distance d
+    std::vector<std::pair<bool, bool>> decisions;
+};
+
+Answers solveAll(const Options &options, const TriangulatedGraph &s, const TriangulatedGraph &t,
+                 std::vector<double> *seconds = nullptr) {
+    Answers answers;
+    for (size_t i = 0; i < options.engines.size(); ++i) {
+        auto begin = std::chrono::steady_clock::now();
+        auto algo = makeFlipDistance(options.engines[i], s, t);
+        answers.distances.push_back(algo->flipDistance());
+        if (options.decisions) {
+            unsigned int d = answers.distances[0];
+            answers.decisions.emplace_back(d > 0 && algo->flipDistanceDecision(d - 1), algo->flipDistanceDecision(d));
+        }
+        if (seconds != nullptr) {
+            (*seconds)[i] += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        }
+    }
+    return answers;
+}
+
+bool mismatch(const Answers &answers) {
+    for (size_t i = 0; i < answers.distances.size(); ++i) {
+        if (answers.distances[i] != answers.distances[0]) {
+            return true;
+        }
+        if (!answers.decisions.empty() && (answers.decisions[i].first || !answers.decisions[i].second)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Smaller instances derived from (s, t): both sides of every common diagonal, and every good flip
+// (a flip creating a diagonal of the other triangulation) on either side.
+std::vector<std::pair<TriangulatedGraph, TriangulatedGraph>> shrinkCandidates(const TriangulatedGraph &s,
+                                                                               const TriangulatedGraph &t) {
+    std::vector<std::pair<TriangulatedGraph, TriangulatedGraph>> candidates;
+    for (const Edge &e: s.getEdges()) {
+        if (t.hasEdge(e)) {
+            candidates.emplace_back(s.subGraph(e.first, e.second), t.subGraph(e.first, e.second));
+            candidates.emplace_back(s.subGraph(e.second, e.first), t.subGraph(e.second, e.first));
+        }
+    }
+    for (bool flipStart: {true, false}) {
+        TriangulatedGraph g = flipStart ? s : t;
+        const TriangulatedGraph &other = flipStart ? t : s;
+        for (const Edge &e: g.getEdges()) {
+            if (other.hasEdge(e)) {
+                continue;
+            }
+            Edge result = g.flip(e);
+            if (other.hasEdge(result)) {
+                candidates.push_back(flipStart ? std::make_pair(g, t) : std::make_pair(s, g));
+            }
+            g.flip(result);
+        }
+    }
+    return candidates;
+}
+
+// Greedily replaces the pair by a smaller one that still makes the engines disagree.
+std::pair<TriangulatedGraph, TriangulatedGraph> minimize(const Options &options, TriangulatedGraph s,
+                                                         TriangulatedGraph t) {
+    bool shrunk = true;
+    while (shrunk) {
+        shrunk = false;
+        for (auto &candidate: shrinkCandidates(s, t)) {
+            if (candidate.first.getSize() >= 4 && mismatch(solveAll(options, candidate.first, candidate.second))) {
+                s = candidate.first;
+                t = candidate.second;
+                shrunk = true;
+                break;
+            }
+        }
+    }
+    return {s, t};
+}
+
+void report(const Options &options, const TriangulatedGraph &s, const TriangulatedGraph &t) {
+    Answers answers = solveAll(options, s, t);
+    printf("MISMATCH n=%zu %s %s\n", s.getSize(),
+           binaryStringToTreeRep(s.toVector()).c_str(), binaryStringToTreeRep(t.toVector()).c_str());
+    for (size_t i = 0; i < options.engines.size(); ++i) {
+        printf("  %-10s distance=%u", options.engines[i].c_str(), answers.distances[i]);
+        if (options.decisions) {
+            printf(" decision(d-1)=%d decision(d)=%d", answers.decisions[i].first, answers.decisions[i].second);
+        }
+        printf("\n");
+    }
+}
+
+std::vector<std::string> split(const std::string &s, char separator) {
+    std::vector<std::string> result;
+    std::stringstream stream(s);
+    std::string item;
+    while (std::getline(stream, item, separator)) {
+        result.push_back(item);
+    }
+    return result;
+}
+
+// Runs every registered engine on seeded random instances in parallel and reports disagreements,
+// each minimized to a smallest failing pair. Instance i only depends on seed + i.
+int main(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--n=", 4) == 0) {
+            if (sscanf(argv[i] + 4, "%d:%d", &options.minN, &options.maxN) == 1) {
+                options.maxN = options.minN;
+            }
+        } else if (strncmp(argv[i], "--count=", 8) == 0) {
+            sscanf(argv[i] + 8, "%lld", &options.count);
+        } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+            sscanf(argv[i] + 7, "%u", &options.seed);
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            sscanf(argv[i] + 10, "%u", &options.threads);
+        } else if (strncmp(argv[i], "--engines=", 10) == 0) {
+            options.engines = split(argv[i] + 10, ',');
+        } else if (strcmp(argv[i], "--no-decisions") == 0) {
+            options.decisions = false;
+        } else {
+            printf("Usage: CrossValidate [--n=min:max] [--count=N] [--seed=S] [--threads=T] "
+                   "[--engines=a,b,...] [--no-decisions]\n");
+            return 1;
+        }
+    }
+    if (options.engines.empty()) {
+        for (const auto &engine: flipDistanceEngines()) {
+            options.engines.push_back(engine.first);
+        }
+    }
+    for (const auto &engine: options.engines) {
+        if (makeFlipDistance(engine, TriangulatedGraph(4), TriangulatedGraph(4)) == nullptr) {
+            printf("No algorithm named %s found.\n", engine.c_str());
+            return 1;
+        }
+    }
+
+    std::atomic<long long> next{0}, mismatches{0};
+    std::mutex outputMutex;
+    std::vector<double> seconds(options.engines.size());
+    auto begin = std::chrono::steady_clock::now();
+    auto worker = [&]() {
+        std::vector<double> local(options.engines.size());
+        for (long long i = next++; i < options.count; i = next++) {
+            std::mt19937 mt(options.seed + (unsigned int) i);
+            int n = options.minN + (int) (mt() % (unsigned int) (options.maxN - options.minN + 1));
+            TriangulatedGraph s(randBits(n - 2, mt)), t(randBits(n - 2, mt));
+            if (!mismatch(solveAll(options, s, t, &local))) {
+                continue;
+            }
+            mismatches++;
+            auto smallest = minimize(options, s, t);
+            std::lock_guard<std::mutex> lock(outputMutex);
+            printf("instance %lld (seed %u):\n", i, options.seed + (unsigned int) i);
+            report(options, smallest.first, smallest.second);
+        }
+        std::lock_guard<std::mutex> lock(outputMutex);
+        for (size_t e = 0; e < local.size(); ++e) {
+            seconds[e] += local[e];
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < options.threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    printf("%lld instances, %lld mismatches, %.2f s, %.1f instances/s\n",
+           options.count, mismatches.load(), elapsed, (double) options.count / elapsed);
+    for (size_t i = 0; i < options.engines.size(); ++i) {
+        printf("  %-10s %.2f s total, %.3f ms/instance\n", options.engines[i].c_str(), seconds[i],
+               seconds[i] * 1000 / (double) options.count);
+    }
+    return mismatches > 0;
+}
@@ -0,0 +1,46 @@
+//
+// Created by agent on 10/17/26.
+//
+#include <cstdio>
+#include <string>
+#include "algo/registry.h"
+#include "utils/generator.h"
+#include "utils/rand.h"
+#include "triangulation/Helper.h"
+
+// Prints `count` lines of "<start> <end> <distance>" with distance in [minDistance, maxDistance].
+int main(int argc, char **argv) {
+    if (argc < 5) {
+        printf("Usage: GenerateInstances n minDistance maxDistance count [seed] [engine]\n");
+        return 1;
+    }
+    int n, count;
+    unsigned int minDistance, maxDistance;
+    sscanf(argv[1], "%d", &n);
+    sscanf(argv[2], "%u", &minDistance);
+    sscanf(argv[3], "%u", &maxDistance);
+    sscanf(argv[4], "%d", &count);
+    if (argc > 5) {
+        unsigned int seed;
+        sscanf(argv[5], "%u", &seed);
+        seedRandom(seed);
+    }
+    std::string engine = argc > 6 ? argv[6] : "source";
+    if (findExactEngine(engine) == nullptr) {
+        // the distances written are ground truth, which approximations cannot certify
+        fprintf(stderr, "No exact engine named %s found.\n", engine.c_str());
+        return 1;
+    }
+    for (int i = 0; i < count; ++i) {
+        auto instance = generateInstance(n, minDistance, maxDistance, engine);
+        if (!instance) {
+            fprintf(stderr, "No %d-gon pair with distance in [%u, %u] found.\n", n, minDistance, maxDistance);
+            return 1;
+        }
+        printf("%s %s %u\n",
+               binaryStringToTreeRep(instance->start.toVector()).c_str(),
+               binaryStringToTreeRep(instance->end.toVector()).c_str(),
+               instance->distance);
+    }
+    return 0;
+}
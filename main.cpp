@@ -1,13 +1,20 @@
 #include <iostream>
 #include "triangulation/TriangulatedGraph.h"
-#include "algo/flip_distance_bfs.h"
-#include "algo/flip_distance_source.h"
+#include "algo/cost_model.h"
+#include "algo/registry.h"
+#include "algo/shortest_paths.h"
+#include "algo/speculative_decisions.h"
 #include "triangulation/Helper.h"
+#include "utils/memory.h"
 #include <unordered_map>
 #include <ctime>
 #include <cstring>
 #include <cassert>
 #include <cstdio>
+#include <condition_variable>
+#include <csignal>
+#include <mutex>
+#include <thread>
 
 using namespace std;
 
@@ -19,43 +26,182 @@ void printTriangulation(const TriangulatedGraph &g) {
 }
 
 FlipDistance* getAlgoByName(const std::string &name, TriangulatedGraph &g, TriangulatedGraph &g2) {
-    if (name == "bfs") return new FlipDistanceBfs(g, g2);
-    if (name == "source") return new FlipDistanceSource(g, g2);
-    printf("No algorithm named %s found.", name.c_str());
-    exit(1);
+    auto algo = makeFlipDistance(name, g, g2);
+    if (algo == nullptr) {
+        printf("No algorithm named %s found.", name.c_str());
+        exit(1);
+    }
+    return algo.release();
 }
 
-std::string vectorToString(const std::vector<int>& v) {
-    std::string res;
-    for (int i : v) {
-        res += std::to_string(i);
-    }
-    return res;
+// Cancelled on SIGINT / SIGTERM so that a checkpointed solve can write its final snapshot before exiting.
+CancellationToken interrupted;
+
+void interrupt(int) {
+    interrupted.cancel();
 }
 
 int main(int argc, char **argv) {
-    if (argc < 3) {
+    std::vector<std::string> args;
+    bool printStatistics = false, profile = false, printMemory = false, printPath = false;
+    double timeLimit = 0, memoryLimitMb = 0, progressInterval = 0;
+    unsigned int speculate = 0;
+    bool countPaths = false;
+    unsigned long long listPaths = 0;
+    std::string tracePath, portfolioLog, modelPath;
+    ShardedBfsOptions sharding;
+    CheckpointOptions checkpoint;
+    unsigned long long traceSample = 1, traceMinMicros = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            printStatistics = true;
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            profile = true;
+        } else if (strcmp(argv[i], "--memory") == 0) {
+            printMemory = true;
+        } else if (strcmp(argv[i], "--progress") == 0) {
+            progressInterval = 1;
+        } else if (strncmp(argv[i], "--progress=", 11) == 0) {
+            sscanf(argv[i] + 11, "%lf", &progressInterval);
+        } else if (strcmp(argv[i], "--path") == 0) {
+            printPath = true;
+        } else if (strncmp(argv[i], "--time-limit=", 13) == 0) {
+            sscanf(argv[i] + 13, "%lf", &timeLimit);
+        } else if (strncmp(argv[i], "--memory-limit=", 15) == 0) {
+            sscanf(argv[i] + 15, "%lf", &memoryLimitMb);
+        } else if (strncmp(argv[i], "--checkpoint=", 13) == 0) {
+            checkpoint.directory = argv[i] + 13;
+        } else if (strncmp(argv[i], "--checkpoint-interval=", 22) == 0) {
+            sscanf(argv[i] + 22, "%lf", &checkpoint.intervalSeconds);
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            checkpoint.resume = true;
+        } else if (strncmp(argv[i], "--speculate=", 12) == 0) {
+            sscanf(argv[i] + 12, "%u", &speculate);
+        } else if (strncmp(argv[i], "--model=", 8) == 0) {
+            modelPath = argv[i] + 8;
+        } else if (strncmp(argv[i], "--portfolio-log=", 16) == 0) {
+            portfolioLog = argv[i] + 16;
+        } else if (strncmp(argv[i], "--shards=", 9) == 0) {
+            sscanf(argv[i] + 9, "%u", &sharding.shards);
+        } else if (strncmp(argv[i], "--shard-dir=", 12) == 0) {
+            sharding.directory = argv[i] + 12;
+        } else if (strcmp(argv[i], "--count-paths") == 0) {
+            countPaths = true;
+        } else if (strncmp(argv[i], "--list-paths=", 13) == 0) {
+            sscanf(argv[i] + 13, "%llu", &listPaths);
+        } else if (strncmp(argv[i], "--trace=", 8) == 0) {
+            tracePath = argv[i] + 8;
+        } else if (strncmp(argv[i], "--trace-sample=", 15) == 0) {
+            sscanf(argv[i] + 15, "%llu", &traceSample);
+        } else if (strncmp(argv[i], "--trace-min-us=", 15) == 0) {
+            sscanf(argv[i] + 15, "%llu", &traceMinMicros);
+        } else {
+            args.emplace_back(argv[i]);
+        }
+    }
+    if (args.size() < 2) {
         fprintf(stderr, "Need at least 2 arguments.");
         return 1;
     }
-    if (strcmp(argv[1], "-c") == 0) {
-        BinaryString bs(treeStringToParentheses(argv[2]));
+    if (args[0] == "-c") {
+        BinaryString bs(treeStringToParentheses(args[1]));
         printTriangulation(TriangulatedGraph(bs.getBits()));
         printf("%s\n", bs.toString().c_str());
         return 0;
     }
     std::string 
-        s1 = std::string(argv[1]),
-        s2 = std::string(argv[2]);
+        s1 = args[0],
+        s2 = args[1];
     
-    TriangulatedGraph g(BinaryString(treeStringToParentheses(s1)).getBits());
-    TriangulatedGraph g2(BinaryString(treeStringToParentheses(s2)).getBits());
-    std::string name = argc > 3 ? argv[3] : "bfs";
-    FlipDistance *m = getAlgoByName(name, g, g2);
+    Profiler profiler;
+    Profiler *activeProfiler = profile ? &profiler : nullptr;
+    std::vector<bool> bits1, bits2;
+    {
+        ScopedPhase phase(activeProfiler, Phase::Parsing);
+        bits1 = BinaryString(treeStringToParentheses(s1)).getBits();
+        bits2 = BinaryString(treeStringToParentheses(s2)).getBits();
+    }
+    auto convert = [&](const std::vector<bool> &bits) {
+        ScopedPhase phase(activeProfiler, Phase::Conversion);
+        return TriangulatedGraph(bits);
+    };
+    TriangulatedGraph g(convert(bits1));
+    TriangulatedGraph g2(convert(bits2));
+    if (countPaths || listPaths > 0) {
+        // distance, number of shortest paths, then the first listPaths of them
+        SearchLimits limits = timeLimit > 0 ? SearchLimits::within(timeLimit) : SearchLimits::none();
+        limits.memoryCap = (uint64_t) (memoryLimitMb * 1024 * 1024);
+        auto dag = ShortestPathDag::build(g, g2, limits);
+        if (!dag) {
+            fprintf(stderr, "Shortest paths not found within the limits (or more than 34 vertices).");
+            return 1;
+        }
+        printf("%u\n", dag->distance());
+        printf("%s\n", dag->countPaths().toString().c_str());
+        auto paths = dag->paths();
+        for (unsigned long long i = 0; i < listPaths; ++i) {
+            auto path = paths.next();
+            if (!path) {
+                break;
+            }
+            printf("%s\n", flipPathToString(*path).c_str());
+        }
+        return 0;
+    }
+    std::string name = args.size() > 2 ? args[2] : "bfs";
+    if (name == "auto") {
+        // the engine with the lowest predicted time, see SolverBenchmark train
+        CostModel model;
+        if (modelPath.empty() || !model.load(modelPath)) {
+            fprintf(stderr, "Engine auto needs a cost model, given with --model=<file>.");
+            return 1;
+        }
+        InstanceFeatures features = extractFeatures(g, g2);
+        name = model.bestEngine(features);
+        fprintf(stderr, "engine: %s (predicted %.3gs)\n", name.c_str(), model.predict(features, name));
+    }
+    if (speculate > 0 && isApproximationEngine(name)) {
+        fprintf(stderr, "--speculate needs an exact engine; %s only bounds the distance.", name.c_str());
+        return 1;
+    }
+    if (speculate > 0 && (checkpoint.enabled() || checkpoint.resume || progressInterval > 0)) {
+        // every decision runs its own solver, with no single search to snapshot or report on
+        fprintf(stderr, "--speculate cannot be combined with --checkpoint, --resume or --progress.");
+        return 1;
+    }
+    // the sharded engine takes its worker count and batch directory from the options
+    FlipDistance *m = name == "sharded" ? makeSharded(sharding)(g, g2).release() : getAlgoByName(name, g, g2);
+    m->setProfiler(activeProfiler);
+    Tracer tracer(1 << 16, traceSample, traceMinMicros * 1000);
+    if (!tracePath.empty()) {
+        m->setTracer(&tracer);
+    }
+    if (checkpoint.resume && !checkpoint.enabled()) {
+        fprintf(stderr, "--resume needs --checkpoint=<directory>.");
+        return 1;
+    }
+    m->setCheckpoint(checkpoint);
+    auto *portfolio = dynamic_cast<FlipDistancePortfolio *>(m);
+    if (portfolio != nullptr) {
+        portfolio->setLog(portfolioLog);
+    }
+    std::mutex progressMutex;
+    std::condition_variable progressDone;
+    bool finished = false;
+    std::thread monitor;
+    if (progressInterval > 0) {
+        monitor = std::thread([&]() {
+            std::unique_lock<std::mutex> lock(progressMutex);
+            auto interval = std::chrono::duration<double>(progressInterval);
+            while (!progressDone.wait_for(lock, interval, [&] { return finished; })) {
+                fprintf(stderr, "progress: %s\n", m->getProgress().toString().c_str());
+            }
+        });
+    }
     bool decision = false;
-    if (argc > 4) {
+    if (args.size() > 3) {
         int input;
-        sscanf(argv[4], "%d", &input);
+        sscanf(args[3].c_str(), "%d", &input);
         decision = input;
     }
     if (decision) {
@@ -63,19 +209,91 @@ int main(int argc, char **argv) {
         for (size_t i = start; i <= end; ++i) {
             // i = g.getSize() * 1.5;
             clock_t startTime = clock();
-            branchCounter = 0;
+            m->resetStatistics();
             printf("%zu %d ", i, m->flipDistanceDecision(i));
             clock_t endTime = clock();
             printf("%.2f %s\n", 
                    (double)(endTime - startTime) / CLOCKS_PER_SEC, 
-                   vectorToString(m->getStatistics()).c_str());
+                   m->getStatistics().toString().c_str());
+        }
+    } else if (timeLimit > 0 || memoryLimitMb > 0 || printPath || checkpoint.enabled() || speculate > 0 ||
+               isApproximationEngine(name)) {
+        SearchLimits limits = timeLimit > 0 ? SearchLimits::within(timeLimit) : SearchLimits::none();
+        limits.memoryCap = (uint64_t) (memoryLimitMb * 1024 * 1024);
+        if (checkpoint.enabled()) {
+            limits.cancellation = interrupted;
+            signal(SIGINT, interrupt);
+            signal(SIGTERM, interrupt);
+        }
+        clock_t startTime = clock();
+        FlipDistanceResult result;
+        StatisticsSnapshot statistics;
+        if (speculate > 0) {
+            SolveRequest request;
+            request.limits = limits;
+            auto configure = [&](FlipDistance &solver) {
+                solver.setProfiler(activeProfiler);
+                if (!tracePath.empty()) {
+                    solver.setTracer(&tracer);
+                }
+            };
+            FlipDistanceFactory factory = name == "sharded" ? makeSharded(sharding) : *findFlipDistanceFactory(name);
+            result = speculativeFlipDistance(factory, g, g2, speculate, request,
+                                             Executor::shared(), configure, &statistics);
+        } else {
+            result = m->solve(limits);
+            statistics = m->getStatistics();
+        }
+        clock_t endTime = clock();
+        if (result.exact) {
+            printf("%u\n", result.upperBound);
+        } else {
+            printf("%u..%u\n", result.lowerBound, result.upperBound);
+        }
+        printf("%.2f\n", (double)(endTime - startTime) / CLOCKS_PER_SEC);
+        printf("%llu\n", (unsigned long long) peakResidentSetKb());
+        if (result.stopReason != StopReason::None) {
+            printf("stopped: %s\n", stopReasonName(result.stopReason));
+        }
+        if (printPath && !result.path.empty()) {
+            printf("%s\n", flipPathToString(result.path).c_str());
+        }
+        if (printStatistics) {
+            printf("%s\n", statistics.toString().c_str());
+        }
+        if (printMemory) {
+            printf("%s\n", memoryReport().toString().c_str());
         }
     } else {
         clock_t startTime = clock();
         printf("%d\n", m->flipDistance());
         clock_t endTime = clock();
         printf("%.2f\n", (double)(endTime - startTime) / CLOCKS_PER_SEC);
-        printf("0\n");
+        printf("%llu\n", (unsigned long long) peakResidentSetKb());
+        if (printStatistics) {
+            printf("%s\n", m->getStatistics().toString().c_str());
+        }
+        if (printMemory) {
+            printf("%s\n", memoryReport().toString().c_str());
+        }
+    }
+    if (monitor.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(progressMutex);
+            finished = true;
+        }
+        progressDone.notify_all();
+        monitor.join();
+    }
+    if (portfolio != nullptr && !portfolio->getWinner().empty()) {
+        fprintf(stderr, "winner: %s\n", portfolio->getWinner().c_str());
+    }
+    if (profile) {
+        fprintf(stderr, "%s", profiler.report().c_str());
+    }
+    if (!tracePath.empty() && !tracer.writeChromeTrace(tracePath)) {
+        fprintf(stderr, "Could not write trace to %s.", tracePath.c_str());
+        return 1;
     }
     return 0;
 }
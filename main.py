@@ -46,13 +46,21 @@ def run_program(t1: str, t2: str, algo_name: str = "bfs") -> tuple[int, float, i
     return int(flip_distance), float(time_usage), int(memory_usage)
 
 
-def run_program_decision(t1: str, t2: str, algo_name: str = "bfs") -> list[tuple[int, bool, float]]:
+def parse_statistics(tokens: list[str]) -> dict[str, str]:
+    return dict(token.split("=", 1) for token in tokens if "=" in token)
+
+
+def run_program_statistics(t1: str, t2: str, algo_name: str = "bfs") -> dict[str, str]:
+    res: str = subprocess.check_output([f"cmake-build-debug/Build", t1, t2, algo_name, "--stats"], text=True)
+    return parse_statistics(res.split("\n")[3].split(" "))
+
+
+def run_program_decision(t1: str, t2: str, algo_name: str = "bfs") -> list[tuple[int, bool, float, dict[str, str]]]:
     res: str = subprocess.check_output([f"cmake-build-debug/Build", t1, t2, algo_name, "1"], text=True)
     result = []
-    for index, line in enumerate(res.split("\n")):
-        k = index + 1
-        ans, time_usage = line.split(" ")
-        result.append((k, ans == "1", float(time_usage)))
+    for line in res.strip().split("\n"):
+        k, ans, time_usage, *statistics = line.split(" ")
+        result.append((int(k), ans == "1", float(time_usage), parse_statistics(statistics)))
     return result
 
 
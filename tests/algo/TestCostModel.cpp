@@ -0,0 +1,79 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "gtest/gtest.h"
+#include "../../algo/cost_model.h"
+#include "../../utils/rand.h"
+
+TEST(TestCostModel, TestSourceSetCount) {
+    seedRandom(11);
+    for (int n = 4; n <= 12; ++n) {
+        auto p = randomTriangulation(n, false);
+        ASSERT_DOUBLE_EQ((double) p.first.getSources().size(), sourceSetCount(p.first));
+    }
+}
+
+TEST(TestCostModel, TestFeatures) {
+    TriangulatedGraph g(8), g2(8);
+    for (Edge e: {Edge(0, 2), Edge(0, 3), Edge(0, 4), Edge(0, 5), Edge(0, 6)}) {
+        g.addEdge(e);
+    }
+    for (Edge e: {Edge(0, 2), Edge(0, 3), Edge(3, 5), Edge(3, 6), Edge(3, 7)}) {
+        g2.addEdge(e);
+    }
+    InstanceFeatures features = extractFeatures(g, g2);
+    ASSERT_EQ(8, features.n);
+    ASSERT_EQ(2, features.commonDiagonals);
+    // the hexagon left of the common diagonals reduces by good flips only
+    ASSERT_EQ(0, features.kernelSize);
+    ASSERT_EQ(5 + 2, features.maxDegreeSum);
+
+    TriangulatedGraph s(6), t(6);
+    for (Edge e: {Edge(0, 2), Edge(2, 4), Edge(0, 4)}) {
+        s.addEdge(e);
+    }
+    for (Edge e: {Edge(1, 3), Edge(3, 5), Edge(1, 5)}) {
+        t.addEdge(e);
+    }
+    ASSERT_EQ(6, extractFeatures(s, t).kernelSize);
+}
+
+TEST(TestCostModel, TestFitAndPredict) {
+    std::vector<CostSample> samples;
+    for (int n = 6; n <= 14; ++n) {
+        InstanceFeatures features;
+        features.n = n;
+        features.kernelSize = n;
+        features.sourceSets = 1;
+        samples.push_back({features, "fast", std::exp(0.1 * n)});
+        samples.push_back({features, "slow", std::exp(0.5 * n - 4)});
+    }
+    CostModel model;
+    model.fit(samples);
+    InstanceFeatures small = samples[0].features, large = samples.back().features;
+    ASSERT_NEAR(std::exp(0.5 * 14 - 4), model.predict(large, "slow"), 0.05 * std::exp(0.5 * 14 - 4));
+    ASSERT_EQ("slow", model.bestEngine(small));
+    ASSERT_EQ("fast", model.bestEngine(large));
+    ASSERT_TRUE(std::isinf(model.predict(large, "missing")));
+
+    std::string path = testing::TempDir() + "cost_model.txt";
+    ASSERT_TRUE(model.save(path));
+    CostModel loaded;
+    ASSERT_TRUE(loaded.load(path));
+    ASSERT_DOUBLE_EQ(model.predict(large, "fast"), loaded.predict(large, "fast"));
+}
+
+TEST(TestCostModel, TestSkipsApproximationEngines) {
+    std::vector<CostSample> samples;
+    for (int n = 6; n <= 14; ++n) {
+        InstanceFeatures features;
+        features.n = n;
+        features.sourceSets = 1;
+        samples.push_back({features, "source", std::exp(0.1 * n)});
+        samples.push_back({features, "approx", std::exp(0.01 * n - 4)});
+    }
+    CostModel model;
+    model.fit(samples);
+    ASSERT_EQ("source", model.bestEngine(samples[0].features));
+}
@@ -3,12 +3,22 @@
 //
 
 #include "gtest/gtest.h"
+#include "../../algo/flip_distance_approx.h"
 #include "../../algo/flip_distance_bfs.h"
+#include "../../algo/flip_distance_bfs_bloom.h"
+#include "../../algo/flip_distance_bfs_sorted.h"
+#include "../../algo/flip_distance_fpt.h"
+#include "../../algo/flip_distance_sharded.h"
 #include "../../algo/flip_distance_source.h"
+#include "../../algo/registry.h"
+#include "../../algo/solver_session.h"
+#include "../../algo/speculative_decisions.h"
 #include "../../triangulation/Helper.h"
+#include "../../utils/rand.h"
 
-void assertFd(TriangulatedGraph &g1, TriangulatedGraph &g2, int distance, int max) {
-    FlipDistanceSource fd(g1, g2);
+template<class T>
+void assertFdWith(TriangulatedGraph &g1, TriangulatedGraph &g2, int distance, int max) {
+    T fd(g1, g2);
     for (int i = 1; i < distance; i++) {
         ASSERT_FALSE(fd.flipDistanceDecision(i));
     }
@@ -18,6 +28,11 @@ void assertFd(TriangulatedGraph &g1, TriangulatedGraph &g2, int distance, int ma
     ASSERT_EQ(distance, fd.flipDistance());
 }
 
+void assertFd(TriangulatedGraph &g1, TriangulatedGraph &g2, int distance, int max) {
+    assertFdWith<FlipDistanceSource>(g1, g2, distance, max);
+    assertFdWith<FlipDistanceFpt>(g1, g2, distance, max);
+}
+
 TEST(TestFlipDistance, TestFlipDistance_withSquare) {
     TriangulatedGraph g(4);
     g.addEdge(0, 2);
@@ -107,3 +122,467 @@ void testFdStr(const std::string& s1, const std::string& s2, int expected) {
 TEST(TestFlipDistance, TestFlipDistance_with14gon) {
     testFdStr("(((a((a((aa)a))a))a)(a(a(aa))))(aa)", "(a(((a((a(a(((aa)a)a)))a))a)(aa)))a", 15);
 }
+
+TEST(TestFlipDistance, TestFlipDistance_withCommonDiagonals) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("(a(a(aa)))a")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a((aa)a))a")).getBits());
+    assertFd(g1, g2, 1, 3);
+    testFdStr("(a(a(aa)))a", "(a((aa)a))a", 1);
+    testFdStr("(a(a(aa)))a", "(a(a(aa)))a", 0);
+}
+
+TEST(TestFlipDistance, TestSolve_pathAndBounds) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("(((a((a((aa)a))a))a)(a(a(aa))))(aa)")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a(((a((a(a(((aa)a)a)))a))a)(aa)))a")).getBits());
+    FlipDistanceBfs bfs(g1, g2);
+    FlipDistanceResult exact = bfs.solve();
+    ASSERT_TRUE(exact.exact);
+    ASSERT_EQ(15, exact.upperBound);
+    ASSERT_EQ(15, exact.path.size());
+    ASSERT_TRUE(isFlipPath(g1, exact.path, g2));
+
+    for (int engine = 0; engine < 2; ++engine) {
+        std::unique_ptr<FlipDistance> fd;
+        if (engine == 0) {
+            fd = std::make_unique<FlipDistanceBfs>(g1, g2);
+        } else {
+            fd = std::make_unique<FlipDistanceSource>(g1, g2);
+        }
+        FlipDistanceResult limited = fd->solve(SearchLimits::within(0));
+        ASSERT_FALSE(limited.exact);
+        ASSERT_EQ(StopReason::Deadline, limited.stopReason);
+        ASSERT_LE(limited.lowerBound, 15);
+        ASSERT_GE(limited.upperBound, 15);
+        ASSERT_EQ(limited.upperBound, limited.path.size());
+        ASSERT_TRUE(isFlipPath(g1, limited.path, g2));
+    }
+}
+
+TEST(TestFlipDistance, TestSolveAsync) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("((a((a(aa))a))a)(a(aa))")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a((a(a(((aa)a)a)))a))a")).getBits());
+    FlipDistanceBfs bfs(g1, g2);
+    FlipDistanceSource source(g1, g2);
+    std::atomic<int> updates{0};
+    SolveRequest request;
+    request.onProgress = [&](const FlipDistanceResult &result) {
+        ASSERT_LE(result.lowerBound, result.upperBound);
+        updates++;
+    };
+    SolveHandle bfsHandle = bfs.solveAsync(request);
+
+    SolveRequest cancelled;
+    cancelled.limits.cancellation.cancel();
+    SolveHandle sourceHandle = source.solveAsync(cancelled);
+
+    const FlipDistanceResult &exact = bfsHandle.get();
+    ASSERT_TRUE(exact.exact);
+    ASSERT_TRUE(isFlipPath(g1, exact.path, g2));
+    ASSERT_LT(0, updates.load());
+    ASSERT_EQ(StopReason::Cancelled, sourceHandle.get().stopReason);
+    ASSERT_FALSE(sourceHandle.get().exact);
+    ASSERT_TRUE(sourceHandle.ready());
+}
+
+TEST(TestFlipDistance, TestProgress) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("((a((a(aa))a))a)(a(aa))")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a((a(a(((aa)a)a)))a))a")).getBits());
+    FlipDistanceSource source(g1, g2);
+    ProgressSnapshot idle = source.getProgress();
+    ASSERT_EQ(-1, idle.k);
+    ASSERT_LT(idle.etaSeconds, 0);
+    FlipDistanceResult result = source.solve();
+    ProgressSnapshot done = source.getProgress();
+    // the distance here equals the fan bound, which solve takes without deciding it
+    ASSERT_EQ((int) result.upperBound - 1, done.k);
+    ASSERT_LE(done.sourceIndex, done.sourceTotal);
+
+    FlipDistanceBfs bfs(g1, g2);
+    bfs.solve();
+    ProgressSnapshot levels = bfs.getProgress();
+    ASSERT_EQ((int) result.upperBound - 1, levels.bfsLevel);
+    ASSERT_LT(0, levels.frontierSize);
+}
+
+TEST(TestFlipDistance, TestCheckpointResume) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("((a((a(aa))a))a)(a(aa))")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a((a(a(((aa)a)a)))a))a")).getBits());
+    CheckpointOptions options;
+    options.directory = testing::TempDir() + "flip_distance_checkpoint";
+    options.intervalSeconds = 1e9;
+    for (int engine = 0; engine < 2; ++engine) {
+        std::unique_ptr<FlipDistance> first, second;
+        std::string file = checkpointPath(options.directory, engine == 0 ? "bfs" : "source");
+        if (engine == 0) {
+            first = std::make_unique<FlipDistanceBfs>(g1, g2);
+            second = std::make_unique<FlipDistanceBfs>(g1, g2);
+        } else {
+            first = std::make_unique<FlipDistanceSource>(g1, g2);
+            second = std::make_unique<FlipDistanceSource>(g1, g2);
+        }
+        first->setCheckpoint(options);
+        SolveRequest request;
+        CancellationToken token = request.limits.cancellation;
+        unsigned int stoppedAt = 0;
+        request.onProgress = [&](const FlipDistanceResult &result) {
+            if (result.lowerBound >= 8) {
+                stoppedAt = result.lowerBound;
+                token.cancel();
+            }
+        };
+        FlipDistanceResult stopped = first->solveAsync(request).get();
+        ASSERT_EQ(StopReason::Cancelled, stopped.stopReason);
+        ASSERT_EQ(stoppedAt, stopped.lowerBound);
+        ASSERT_TRUE(CheckpointReader(file, engine == 0 ? "bfs" : "source").good());
+
+        options.resume = true;
+        second->setCheckpoint(options);
+        SolveRequest resume;
+        resume.limits = SearchLimits::none();
+        resume.onProgress = [&](const FlipDistanceResult &result) {
+            ASSERT_LE(stoppedAt, result.lowerBound);
+        };
+        FlipDistanceResult resumed = second->solveAsync(resume).get();
+        options.resume = false;
+        ASSERT_TRUE(resumed.exact);
+        ASSERT_EQ(10, resumed.upperBound);
+        if (engine == 0) {
+            ASSERT_TRUE(isFlipPath(g1, resumed.path, g2));
+        }
+        ASSERT_FALSE(CheckpointReader(file, engine == 0 ? "bfs" : "source").good());
+    }
+}
+
+TEST(TestFlipDistance, TestBfsMemoryFallback) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("((a((a(aa))a))a)(a(aa))")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a((a(a(((aa)a)a)))a))a")).getBits());
+    FlipDistanceBfs bfs(g1, g2);
+    FlipDistanceResult result = bfs.solve(SearchLimits::within(1e9, 64 * 1024));
+    ASSERT_TRUE(result.exact);
+    ASSERT_EQ(10, result.upperBound);
+#ifdef FLIP_DISTANCE_STATISTICS
+    StatisticsSnapshot statistics = bfs.getStatistics();
+    ASSERT_EQ(1, statistics.fallbacks);
+    ASSERT_LT(0, statistics.fallbackLevel);
+    ASSERT_LT(0, statistics.sourceSetsTried);
+#endif
+}
+
+TEST(TestFlipDistance, TestBfsSorted) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("(((a((a((aa)a))a))a)(a(a(aa))))(aa)")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a(((a((a(a(((aa)a)a)))a))a)(aa)))a")).getBits());
+    for (unsigned int threads: {1u, 4u}) {
+        FlipDistanceBfsSorted fd(g1, g2, threads);
+        FlipDistanceResult result = fd.solve();
+        ASSERT_TRUE(result.exact);
+        ASSERT_EQ(15, result.upperBound);
+        ASSERT_EQ(15, result.path.size());
+        ASSERT_TRUE(isFlipPath(g1, result.path, g2));
+        // every level repeats triangulations of the ones before it
+        StatisticsSnapshot statistics = fd.getStatistics();
+        ASSERT_LT(statistics.frontierSizes.size(), statistics.cacheHits);
+        ASSERT_LT(statistics.frontierSizes.size(), statistics.cacheMisses);
+    }
+    FlipDistanceResult limited = FlipDistanceBfsSorted(g1, g2).solve(SearchLimits::within(0));
+    ASSERT_FALSE(limited.exact);
+    ASSERT_EQ(StopReason::Deadline, limited.stopReason);
+    ASSERT_TRUE(isFlipPath(g1, limited.path, g2));
+
+    TriangulatedGraph
+        h1(BinaryString(treeStringToParentheses("((a((a(aa))a))a)(a(aa))")).getBits()),
+        h2(BinaryString(treeStringToParentheses("(a((a(a(((aa)a)a)))a))a")).getBits());
+    FlipDistanceBfsSorted capped(h1, h2);
+    FlipDistanceResult fallback = capped.solve(SearchLimits::within(1e9, 4 * 1024));
+    ASSERT_TRUE(fallback.exact);
+    ASSERT_EQ(10, fallback.upperBound);
+#ifdef FLIP_DISTANCE_STATISTICS
+    ASSERT_EQ(1, capped.getStatistics().fallbacks);
+#endif
+}
+
+TEST(TestFlipDistance, TestBfsBloom) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("(((a((a((aa)a))a))a)(a(a(aa))))(aa)")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a(((a((a(a(((aa)a)a)))a))a)(aa)))a")).getBits());
+    FlipDistanceBfsBloom fd(g1, g2, {1 << 22, 1e-4, 1});
+    FlipDistanceResult result = fd.solve();
+    ASSERT_EQ(15, result.upperBound);
+    ASSERT_TRUE(isFlipPath(g1, result.path, g2));
+    ASSERT_EQ(15, fd.getVerifiedDistance());
+#ifdef FLIP_DISTANCE_STATISTICS
+    StatisticsSnapshot statistics = fd.getStatistics();
+    ASSERT_DOUBLE_EQ(1e-4, statistics.filterFalsePositiveRate);
+    ASSERT_LT(0, statistics.filterEstimatedRate);
+#endif
+
+    // a filter far too small prunes most states, but every answer is still a path
+    FlipDistanceBfsBloom small(g1, g2, {64, 1e-4, -1});
+    FlipDistanceResult bound = small.solve();
+    ASSERT_LE(15, bound.upperBound);
+    ASSERT_EQ(bound.upperBound, bound.path.size());
+    ASSERT_TRUE(isFlipPath(g1, bound.path, g2));
+    ASSERT_FALSE(small.getVerifiedDistance().has_value());
+
+    // a longer path proves nothing about k below it, so only k at or above it is decided
+    FlipDistanceResult below = small.decideWithin(bound.upperBound - 1, SearchLimits::none());
+    ASSERT_FALSE(below.decides(bound.upperBound - 1).has_value());
+    ASSERT_EQ(flipDistanceLowerBound(g1, g2), below.lowerBound);
+    ASSERT_EQ(StopReason::None, below.stopReason);
+    FlipDistanceResult at = small.decideWithin(bound.upperBound, SearchLimits::none());
+    ASSERT_EQ(std::optional<bool>(true), at.decides(bound.upperBound));
+    ASSERT_TRUE(small.flipDistanceDecision(bound.upperBound));
+}
+
+TEST(TestFlipDistance, TestSharded) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("((a((a(aa))a))a)(a(aa))")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a((a(a(((aa)a)a)))a))a")).getBits());
+    std::string directory = (std::filesystem::temp_directory_path() / "flipdistance-test-shards").string();
+    for (unsigned int shards: {1u, 3u}) {
+        FlipDistanceSharded fd(g1, g2, {shards, directory});
+        FlipDistanceResult result = fd.solve();
+        ASSERT_TRUE(result.exact);
+        ASSERT_EQ(10, result.upperBound);
+        ASSERT_TRUE(isFlipPath(g1, result.path, g2));
+        ASSERT_TRUE(std::filesystem::is_empty(directory));
+    }
+    std::filesystem::remove_all(directory);
+
+    // batches that cannot be written make the search fall back to Source
+    FlipDistanceSharded broken(g1, g2, {2, "/proc/flipdistance"});
+    FlipDistanceResult fallback = broken.solve();
+    ASSERT_TRUE(fallback.exact);
+    ASSERT_EQ(10, fallback.upperBound);
+#ifdef FLIP_DISTANCE_STATISTICS
+    ASSERT_EQ(1, broken.getStatistics().fallbacks);
+#endif
+}
+
+TEST(TestFlipDistance, TestPortfolio) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("((a((a(aa))a))a)(a(aa))")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a((a(a(((aa)a)a)))a))a")).getBits());
+    FlipDistancePortfolio portfolio(g1, g2, {{"bfs",    makeEngine<FlipDistanceBfs>},
+                                             {"source", makeEngine<FlipDistanceSource>}});
+    FlipDistanceResult result = portfolio.solve();
+    ASSERT_TRUE(result.exact);
+    ASSERT_EQ(10, result.upperBound);
+    ASSERT_TRUE(portfolio.getWinner() == "bfs" || portfolio.getWinner() == "source");
+    ASSERT_EQ(10, portfolio.flipDistance());
+
+    SearchLimits cancelled;
+    cancelled.cancellation.cancel();
+    FlipDistanceResult stopped = portfolio.solve(cancelled);
+    ASSERT_FALSE(stopped.exact);
+    ASSERT_EQ(StopReason::Cancelled, stopped.stopReason);
+}
+
+TEST(TestFlipDistance, TestSpeculativeDecisions) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("((a((a(aa))a))a)(a(aa))")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a((a(a(((aa)a)a)))a))a")).getBits());
+    Executor executor(4);
+    for (unsigned int window: {1u, 3u, 8u}) {
+        std::vector<unsigned int> lowerBounds;
+        SolveRequest request;
+        request.onProgress = [&](const FlipDistanceResult &result) {
+            lowerBounds.push_back(result.lowerBound);
+        };
+        StatisticsSnapshot statistics;
+        int configured = 0;
+        FlipDistanceResult result = speculativeFlipDistance(makeEngine<FlipDistanceSource>, g1, g2, window,
+                                                            request, executor,
+                                                            [&](FlipDistance &) { configured++; }, &statistics);
+        ASSERT_TRUE(result.exact);
+        ASSERT_EQ(10, result.upperBound);
+        ASSERT_TRUE(std::is_sorted(lowerBounds.begin(), lowerBounds.end()));
+        ASSERT_LT(0, configured);
+        ASSERT_LT(0u, statistics.flips);
+    }
+    // engines without a decision procedure are solved once, and approximations keep the bounds they proved
+    FlipDistanceResult approx = FlipDistanceApprox(g1, g2).solve();
+    int configured = 0;
+    FlipDistanceResult speculated = speculativeFlipDistance(makeEngine<FlipDistanceApprox>, g1, g2, 3, SolveRequest(),
+                                                            executor, [&](FlipDistance &) { configured++; });
+    ASSERT_EQ(1, configured);
+    ASSERT_EQ(approx.lowerBound, speculated.lowerBound);
+    ASSERT_EQ(approx.upperBound, speculated.upperBound);
+    ASSERT_EQ(StopReason::None, speculated.stopReason);
+    ASSERT_TRUE(isFlipPath(g1, speculated.path, g2));
+    SolveRequest cancelled;
+    cancelled.limits.cancellation.cancel();
+    FlipDistanceResult stopped = speculativeFlipDistance(makeEngine<FlipDistanceSource>, g1, g2, 4, cancelled,
+                                                         executor);
+    ASSERT_FALSE(stopped.exact);
+    ASSERT_EQ(StopReason::Cancelled, stopped.stopReason);
+}
+
+TEST(TestFlipDistance, TestFpt_with14gon) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("(((a((a((aa)a))a))a)(a(a(aa))))(aa)")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a(((a((a(a(((aa)a)a)))a))a)(aa)))a")).getBits());
+    FlipDistanceFpt fd(g1, g2);
+    ASSERT_FALSE(fd.flipDistanceDecision(14));
+    ASSERT_TRUE(fd.flipDistanceDecision(15));
+}
+
+TEST(TestFlipDistance, TestApprox_boundsAndRatio) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("(((a((a((aa)a))a))a)(a(a(aa))))(aa)")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a(((a((a(a(((aa)a)a)))a))a)(aa)))a")).getBits());
+    FlipDistanceResult result = FlipDistanceApprox(g1, g2).solve();
+    ASSERT_LE(result.lowerBound, 15);
+    ASSERT_GE(result.upperBound, 15);
+    ASSERT_LE(result.upperBound, 2 * result.lowerBound);
+    ASSERT_EQ(result.upperBound, result.path.size());
+    ASSERT_TRUE(isFlipPath(g1, result.path, g2));
+
+    seedRandom(68);
+    for (int n: {6, 9, 12, 200}) {
+        for (int i = 0; i < 10; ++i) {
+            auto pair = randomTriangulation(n, false);
+            result = FlipDistanceApprox(pair.first, pair.second).solve();
+            ASSERT_LE(result.upperBound, 2 * result.lowerBound);
+            ASSERT_EQ(result.exact, result.lowerBound == result.upperBound);
+            ASSERT_TRUE(isFlipPath(pair.first, result.path, pair.second));
+            if (n <= 12) {
+                unsigned int distance = FlipDistanceFpt(pair.first, pair.second).flipDistance();
+                ASSERT_LE(result.lowerBound, distance);
+                ASSERT_GE(result.upperBound, distance);
+            }
+        }
+    }
+}
+
+TEST(TestFlipDistance, TestSourceOrdering) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("((a((a(aa))a))a)(a(aa))")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a((a(a(((aa)a)a)))a))a")).getBits());
+    for (OrderingWeights weights: {OrderingWeights{1, 0, 0}, OrderingWeights{1, -1, 0}, OrderingWeights{1, 0, 2}}) {
+        FlipDistanceSource fd(g1, g2);
+        fd.setOrdering(std::make_shared<ScoredSourceOrdering>(weights));
+        ASSERT_FALSE(fd.flipDistanceDecision(9));
+        ASSERT_TRUE(fd.flipDistanceDecision(10));
+        ASSERT_TRUE(fd.flipDistanceDecision(11));
+        ASSERT_EQ(10, fd.flipDistance());
+    }
+}
+
+TEST(TestFlipDistance, TestSpecialInstances) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("(((a((a((aa)a))a))a)(a(a(aa))))(aa)")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a(((a((a(a(((aa)a)a)))a))a)(aa)))a")).getBits());
+    ASSERT_FALSE(solveSpecialInstance(g1, g2).has_value());
+
+    // flipping g1 into a fan is a shortest path, and so is its reverse
+    TriangulatedGraph fan = g1;
+    flipToFan(fan, 3);
+    for (const auto &instance: {std::make_pair(g1, fan), std::make_pair(fan, g1)}) {
+        auto special = solveSpecialInstance(instance.first, instance.second);
+        ASSERT_TRUE(special.has_value());
+        ASSERT_TRUE(special->exact);
+        ASSERT_EQ(flipDistanceLowerBound(g1, fan), special->upperBound);
+        ASSERT_TRUE(isFlipPath(instance.first, special->path, instance.second));
+        FlipDistanceSource source(instance.first, instance.second);
+        ASSERT_EQ(special->upperBound, source.flipDistance());
+        ASSERT_LT(0, source.getStatistics().specialInstances);
+    }
+
+    seedRandom(70);
+    for (int i = 0; i < 100; ++i) {
+        auto pair = randomTriangulation(9, false);
+        auto special = solveSpecialInstance(pair.first, pair.second);
+        if (special) {
+            ASSERT_EQ(FlipDistanceFpt(pair.first, pair.second).flipDistance(), special->upperBound);
+            ASSERT_TRUE(isFlipPath(pair.first, special->path, pair.second));
+        }
+    }
+}
+
+TEST(TestFlipDistance, TestReduceToKernels) {
+    // two hexagons joined along the common diagonal 0-5, one reducing completely and one a kernel
+    TriangulatedGraph s(10), t(10);
+    for (Edge e: {Edge(0, 5), Edge(0, 2), Edge(0, 3), Edge(0, 4), Edge(5, 7), Edge(7, 9), Edge(5, 9)}) {
+        s.addEdge(e);
+    }
+    for (Edge e: {Edge(0, 5), Edge(1, 5), Edge(2, 5), Edge(3, 5), Edge(6, 8), Edge(8, 0), Edge(6, 0)}) {
+        t.addEdge(e);
+    }
+    std::vector<Edge> path;
+    auto kernels = reduceToKernels(InstancePiece::whole(s, t), path);
+    ASSERT_EQ(3, path.size());
+    ASSERT_EQ(1, kernels.size());
+    ASSERT_EQ(std::vector<int>({0, 5, 6, 7, 8, 9}), kernels[0].vertices);
+    for (const Edge &e: kernels[0].start.getEdges()) {
+        ASSERT_TRUE(s.hasEdge(kernels[0].original(e)));
+        ASSERT_FALSE(kernels[0].end.hasEdge(e));
+    }
+    for (const Edge &e: kernels[0].end.getEdges()) {
+        ASSERT_TRUE(t.hasEdge(kernels[0].original(e)));
+    }
+    ASSERT_TRUE(reduceToKernels(InstancePiece::whole(s, s), path).empty());
+}
+
+TEST(TestFlipDistance, TestSolverSession) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("((a((a(aa))a))a)(a(aa))")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a((a(a(((aa)a)a)))a))a")).getBits());
+    SolverSession session(g1, g2);
+    FlipDistanceResult first = session.solve();
+    ASSERT_EQ(10, first.upperBound);
+    ASSERT_TRUE(isFlipPath(g1, first.path, g2));
+    uint64_t solved = session.getKernelsSolved();
+
+    Edge e = session.getEnd().getEdges()[0];
+    ASSERT_TRUE(session.flipEnd(e));
+    ASSERT_FALSE(session.flipEnd(Edge(0, 1)));
+    FlipDistanceResult edited = session.solve();
+    ASSERT_TRUE(edited.exact);
+    ASSERT_TRUE(isFlipPath(g1, edited.path, session.getEnd()));
+    ASSERT_EQ(FlipDistanceSource(g1, session.getEnd()).flipDistance(), edited.upperBound);
+
+    // undoing the edit is answered from the cache
+    TriangulatedGraph end = session.getEnd();
+    ASSERT_TRUE(session.flipEnd(end.flip(e)));
+    solved = session.getKernelsSolved();
+    ASSERT_EQ(10, session.solve().upperBound);
+    ASSERT_EQ(solved, session.getKernelsSolved());
+
+    // stopped solves keep the previous path, extended by the edits
+    ASSERT_TRUE(session.flipStart(session.getStart().getEdges()[1]));
+    session.clearCache();
+    FlipDistanceResult stopped = session.solve(SearchLimits::within(0));
+    ASSERT_LE(stopped.upperBound, 11);
+    ASSERT_LE(9, stopped.lowerBound);
+    ASSERT_EQ(stopped.upperBound, stopped.path.size());
+    ASSERT_TRUE(isFlipPath(session.getStart(), stopped.path, g2));
+
+    // the Source engine answers without paths
+    SolverSession decisions(g1, g2, makeEngine<FlipDistanceSource>);
+    FlipDistanceResult exact = decisions.solve();
+    ASSERT_TRUE(exact.exact);
+    ASSERT_EQ(10, exact.upperBound);
+
+    seedRandom(11);
+    for (int i = 0; i < 10; ++i) {
+        auto p = randomTriangulation(9, false);
+        SolverSession random(p.first, p.second);
+        random.solve();
+        for (int edit = 0; edit < 3; ++edit) {
+            std::vector<Edge> edges = (edit % 2 ? random.getStart() : random.getEnd()).getEdges();
+            Edge flip = edges[(size_t) (i + edit) % edges.size()];
+            ASSERT_TRUE(edit % 2 ? random.flipStart(flip) : random.flipEnd(flip));
+            FlipDistanceResult result = random.solve();
+            ASSERT_TRUE(result.exact);
+            ASSERT_EQ(FlipDistanceFpt(random.getStart(), random.getEnd()).flipDistance(), result.upperBound);
+            ASSERT_TRUE(isFlipPath(random.getStart(), result.path, random.getEnd()));
+        }
+    }
+}
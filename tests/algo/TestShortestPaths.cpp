@@ -0,0 +1,75 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <set>
+#include "gtest/gtest.h"
+#include "../../algo/flip_distance_bfs.h"
+#include "../../algo/shortest_paths.h"
+#include "../../triangulation/Helper.h"
+#include "../../utils/rand.h"
+
+// Number of flip sequences of length k from s to t, by trying all of them.
+static uint64_t countByBruteForce(TriangulatedGraph &s, const TriangulatedGraph &t, unsigned int k) {
+    if (k == 0) {
+        return s == t ? 1 : 0;
+    }
+    uint64_t total = 0;
+    for (const Edge &e: s.getEdges()) {
+        Edge created = s.flip(e);
+        total += countByBruteForce(s, t, k - 1);
+        s.flip(created);
+    }
+    return total;
+}
+
+TEST(TestShortestPaths, TestSquare) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("(aa)a")).getBits()),
+        g2(BinaryString(treeStringToParentheses("a(aa)")).getBits());
+    auto dag = ShortestPathDag::build(g1, g2);
+    ASSERT_TRUE(dag.has_value());
+    ASSERT_EQ(1, dag->distance());
+    ASSERT_EQ("1", dag->countPaths().toString());
+    auto paths = dag->paths();
+    auto path = paths.next();
+    ASSERT_TRUE(path.has_value());
+    ASSERT_TRUE(isFlipPath(g1, *path, g2));
+    ASSERT_FALSE(paths.next().has_value());
+
+    auto same = ShortestPathDag::build(g1, g1);
+    ASSERT_EQ(0, same->distance());
+    ASSERT_EQ("1", same->countPaths().toString());
+    ASSERT_EQ(std::vector<Edge>(), same->paths().next());
+}
+
+TEST(TestShortestPaths, TestCountAndEnumerate) {
+    seedRandom(3);
+    for (int i = 0; i < 10; ++i) {
+        auto p = randomTriangulation(8, false);
+        auto dag = ShortestPathDag::build(p.first, p.second);
+        ASSERT_TRUE(dag.has_value());
+        ASSERT_EQ(FlipDistanceBfs(p.first, p.second).flipDistance(), dag->distance());
+        uint64_t expected = countByBruteForce(p.first, p.second, dag->distance());
+        ASSERT_EQ(std::to_string(expected), dag->countPaths().toString());
+        std::set<std::vector<std::pair<int, int>>> seen;
+        auto paths = dag->paths();
+        while (auto path = paths.next()) {
+            ASSERT_EQ(dag->distance(), path->size());
+            ASSERT_TRUE(isFlipPath(p.first, *path, p.second));
+            std::vector<std::pair<int, int>> key;
+            for (const Edge &e: *path) {
+                key.emplace_back(e.first, e.second);
+            }
+            ASSERT_TRUE(seen.insert(key).second);
+        }
+        ASSERT_EQ(expected, seen.size());
+    }
+}
+
+TEST(TestShortestPaths, TestLimits) {
+    TriangulatedGraph
+        g1(BinaryString(treeStringToParentheses("(((a((a((aa)a))a))a)(a(a(aa))))(aa)")).getBits()),
+        g2(BinaryString(treeStringToParentheses("(a(((a((a(a(((aa)a)a)))a))a)(aa)))a")).getBits());
+    ASSERT_FALSE(ShortestPathDag::build(g1, g2, SearchLimits::within(0)).has_value());
+}
@@ -0,0 +1,37 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <thread>
+#include "gtest/gtest.h"
+#include "../../algo/statistics.h"
+
+TEST(TestStatistics, TestCountersPerThread) {
+    Statistics statistics;
+    statistics.local().expand(3);
+    std::thread([&]() {
+        statistics.local().expand(3, 2);
+        statistics.local().expand(1500);
+    }).join();
+    StatisticsSnapshot snapshot = statistics.snapshot();
+    ASSERT_EQ(1501u, snapshot.nodesPerDepth.size());
+    ASSERT_EQ(3u, snapshot.nodesPerDepth[3]);
+    ASSERT_EQ(1u, snapshot.nodesPerDepth[1500]);
+    ASSERT_EQ(4u, snapshot.nodesExpanded());
+    statistics.reset();
+    ASSERT_EQ(0u, statistics.snapshot().nodesExpanded());
+}
+
+TEST(TestStatistics, TestAddSnapshots) {
+    Statistics first, second;
+    first.local().expand(2);
+    first.local().flip(5);
+    second.local().expand(4, 3);
+    second.local().fallback(6);
+    StatisticsSnapshot total = first.snapshot();
+    total.add(second.snapshot());
+    ASSERT_EQ(std::vector<uint64_t>({0, 0, 1, 0, 3}), total.nodesPerDepth);
+    ASSERT_EQ(5u, total.flips);
+    ASSERT_EQ(1u, total.fallbacks);
+    ASSERT_EQ(6, total.fallbackLevel);
+}
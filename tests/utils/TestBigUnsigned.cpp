@@ -0,0 +1,22 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "gtest/gtest.h"
+#include "../../utils/big_unsigned.h"
+
+TEST(TestBigUnsigned, TestAddAndPrint) {
+    ASSERT_EQ("0", BigUnsigned().toString());
+    ASSERT_EQ("18446744073709551615", BigUnsigned(UINT64_MAX).toString());
+    BigUnsigned sum(UINT64_MAX);
+    sum += BigUnsigned(1);
+    ASSERT_FALSE(sum.fitsUint64());
+    ASSERT_EQ("18446744073709551616", sum.toString());
+    sum += sum;
+    ASSERT_EQ("36893488147419103232", sum.toString());
+    BigUnsigned small(1000000000);
+    small += BigUnsigned(7);
+    ASSERT_TRUE(small.fitsUint64());
+    ASSERT_EQ(1000000007, small.toUint64());
+    ASSERT_EQ("1000000007", small.toString());
+}
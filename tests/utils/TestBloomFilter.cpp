@@ -0,0 +1,47 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <random>
+#include "gtest/gtest.h"
+#include "../../utils/bloom_filter.h"
+
+TEST(TestBloomFilter, TestNoFalseNegatives) {
+    BlockedBloomFilter filter(1 << 16, BlockedBloomFilter::hashesFor(1e-3));
+    for (uint64_t key = 0; key < 10000; ++key) {
+        filter.insert(key * 7919);
+    }
+    for (uint64_t key = 0; key < 10000; ++key) {
+        ASSERT_TRUE(filter.contains(key * 7919));
+        ASSERT_TRUE(filter.insert(key * 7919));
+    }
+    // keys hit by a false positive on insertion are not counted
+    ASSERT_GE(10000, filter.size());
+    ASSERT_LE(9990, filter.size());
+}
+
+TEST(TestBloomFilter, TestFalsePositiveRate) {
+    const double rate = 1e-2;
+    BlockedBloomFilter filter(1 << 16, BlockedBloomFilter::hashesFor(rate));
+    size_t capacity = filter.capacity(rate);
+    ASSERT_NEAR(rate, filter.falsePositiveRate(capacity), rate / 10);
+    std::mt19937_64 random(5);
+    for (size_t i = 0; i < capacity; ++i) {
+        filter.insert(random());
+    }
+    size_t positives = 0, trials = 100000;
+    for (size_t i = 0; i < trials; ++i) {
+        positives += filter.contains(random());
+    }
+    // blocking costs a little accuracy
+    ASSERT_LT((double) positives / trials, 2 * rate);
+}
+
+TEST(TestBloomFilter, TestHashBits) {
+    std::vector<bool> a(100), b(100);
+    b[99] = true;
+    ASSERT_EQ(hashBits(a), hashBits(a));
+    ASSERT_NE(hashBits(a), hashBits(b));
+    ASSERT_NE(hashBits(a), hashBits(a, 1));
+    ASSERT_NE(hashBits(a), hashBits(std::vector<bool>(99)));
+}
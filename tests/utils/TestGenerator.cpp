@@ -0,0 +1,48 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "gtest/gtest.h"
+#include "../../algo/flip_distance_bfs.h"
+#include "../../algo/flip_distance_bounds.h"
+#include "../../utils/generator.h"
+#include "../../utils/rand.h"
+
+TEST(TestGenerator, TestFanPath) {
+    seedRandom(7);
+    for (int i = 0; i < 20; ++i) {
+        auto p = randomTriangulation(9, false);
+        int v = bestFanVertex(p.first, p.second);
+        auto path = fanPath(p.first, p.second, v);
+        ASSERT_EQ(fanDistance(p.first, p.second, v), path.size());
+        ASSERT_TRUE(isFlipPath(p.first, path, p.second));
+        ASSERT_LE(flipDistanceLowerBound(p.first, p.second), path.size());
+    }
+}
+
+TEST(TestGenerator, TestDistanceInRange) {
+    seedRandom(42);
+    for (int i = 0; i < 10; ++i) {
+        auto instance = generateInstance(9, 6, 8, i % 3 == 0 ? "source" : i % 3 == 1 ? "bfs" : "fpt");
+        ASSERT_TRUE(instance.has_value());
+        ASSERT_LE(6, instance->distance);
+        ASSERT_GE(8, instance->distance);
+        FlipDistanceBfs bfs(instance->start, instance->end);
+        ASSERT_EQ(instance->distance, bfs.flipDistance());
+    }
+}
+
+TEST(TestGenerator, TestByConstruction) {
+    seedRandom(3);
+    auto instance = generateInstance(12, 4, 4);
+    ASSERT_TRUE(instance.has_value());
+    ASSERT_EQ(4, instance->distance);
+    ASSERT_EQ(4, flipDistanceLowerBound(instance->start, instance->end));
+}
+
+TEST(TestGenerator, TestOnlyExactEngines) {
+    // approximations only bound the distance, so they cannot certify it
+    ASSERT_FALSE(generateInstance(9, 6, 8, "approx").has_value());
+    ASSERT_FALSE(generateInstance(9, 6, 8, "bfs-bloom").has_value());
+    ASSERT_FALSE(generateInstance(9, 6, 8, "unknown").has_value());
+}
@@ -0,0 +1,33 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "../../utils/memory.h"
+
+namespace {
+    struct alignas(64) Line {
+        uint64_t words[8];
+    };
+}
+
+TEST(TestMemory, TestAlignedAllocationsCounted) {
+    if (!memoryAccountingEnabled()) {
+        GTEST_SKIP() << "built without FLIP_DISTANCE_MEMORY_ACCOUNTING";
+    }
+    uint64_t before = liveHeapBytes();
+    {
+        std::vector<Line> lines(1000);
+        ASSERT_EQ(0u, (uintptr_t) lines.data() % 64);
+        ASSERT_LE(before + 1000 * sizeof(Line), liveHeapBytes());
+        auto single = std::make_unique<Line>();
+        ASSERT_EQ(0u, (uintptr_t) single.get() % 64);
+        auto *array = new Line[3];
+        ASSERT_EQ(0u, (uintptr_t) array % 64);
+        delete[] array;
+    }
+    ASSERT_EQ(before, liveHeapBytes());
+}
@@ -0,0 +1,30 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "../../utils/profiler.h"
+
+TEST(TestProfiler, TestTotalsAcrossThreads) {
+    Profiler profiler(false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 1000; ++i) {
+                ScopedPhase phase(&profiler, Phase::FinalCheck);
+                // nested occurrences are only measured at the outermost level
+                ScopedPhase nested(&profiler, Phase::FinalCheck);
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    PhaseTotals totals = profiler.getTotals(Phase::FinalCheck);
+    ASSERT_EQ(4000u, totals.calls);
+    ASSERT_LE(0, totals.wallSeconds);
+    ASSERT_FALSE(totals.hasCounters);
+    ASSERT_EQ(0u, profiler.getTotals(Phase::Search).calls);
+}
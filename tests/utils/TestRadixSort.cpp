@@ -0,0 +1,58 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <algorithm>
+#include <random>
+#include "gtest/gtest.h"
+#include "../../utils/radix_sort.h"
+
+static std::vector<uint64_t> randomKeys(size_t count, uint64_t mask, unsigned int seed) {
+    std::mt19937_64 random(seed);
+    std::vector<uint64_t> keys(count);
+    for (auto &key: keys) {
+        key = random() & mask;
+    }
+    return keys;
+}
+
+TEST(TestRadixSort, TestSort) {
+    // small inputs take the sequential path, large ones the parallel one
+    for (size_t count: {0, 1, 100, 200000}) {
+        for (uint64_t mask: {0xFFull, 0xFFFF0000ull, ~0ull}) {
+            auto keys = randomKeys(count, mask, (unsigned int) count);
+            auto expected = keys;
+            std::sort(expected.begin(), expected.end());
+            radixSort(keys, 4);
+            ASSERT_EQ(expected, keys);
+        }
+    }
+}
+
+TEST(TestRadixSort, TestSortOnPool) {
+    Executor pool(2);
+    for (unsigned int round = 0; round < 3; ++round) {
+        auto keys = randomKeys(100000, UINT64_MAX, round);
+        auto expected = keys;
+        std::sort(expected.begin(), expected.end());
+        radixSort(keys, 3, &pool);
+        ASSERT_EQ(expected, keys);
+    }
+}
+
+TEST(TestRadixSort, TestUniqueAndRemove) {
+    auto keys = randomKeys(150000, 0xFFFFF, 3);
+    auto expected = keys;
+    std::sort(expected.begin(), expected.end());
+    expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+    radixSortUnique(keys, 3);
+    ASSERT_EQ(expected, keys);
+
+    auto removed = randomKeys(50000, 0xFFFFF, 4);
+    radixSortUnique(removed);
+    std::vector<uint64_t> difference;
+    std::set_difference(expected.begin(), expected.end(), removed.begin(), removed.end(),
+                        std::back_inserter(difference));
+    removeSorted(keys, removed);
+    ASSERT_EQ(difference, keys);
+}
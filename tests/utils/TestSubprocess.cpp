@@ -0,0 +1,41 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <csignal>
+#include <unistd.h>
+#include "gtest/gtest.h"
+#include "../../utils/subprocess.h"
+
+TEST(TestSubprocess, TestEcho) {
+    Subprocess child([](int in, int out) {
+        std::vector<uint64_t> message;
+        while (readMessage(in, message) && !message.empty()) {
+            message.push_back(message.size());
+            writeMessage(out, message);
+        }
+        return 3;
+    });
+    ASSERT_TRUE(child.running());
+    std::vector<uint64_t> reply;
+    ASSERT_TRUE(child.send({7, 8}));
+    ASSERT_TRUE(child.receive(reply));
+    ASSERT_EQ(std::vector<uint64_t>({7, 8, 2}), reply);
+    ASSERT_TRUE(child.send({}));
+    ASSERT_EQ(3, child.wait());
+}
+
+TEST(TestSubprocess, TestWriteToClosedPipe) {
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    close(fds[0]);
+    // fails instead of raising SIGPIPE, and leaves its disposition alone
+    ASSERT_FALSE(writeMessage(fds[1], {1, 2, 3}));
+    close(fds[1]);
+    struct sigaction action{};
+    ASSERT_EQ(0, sigaction(SIGPIPE, nullptr, &action));
+    ASSERT_EQ(SIG_DFL, action.sa_handler);
+    sigset_t pending;
+    sigpending(&pending);
+    ASSERT_FALSE(sigismember(&pending, SIGPIPE));
+}
@@ -0,0 +1,33 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include <thread>
+#include "gtest/gtest.h"
+#include "../../utils/thread_slots.h"
+
+TEST(TestThreadSlots, TestOneSlotPerThread) {
+    ThreadSlots<int> slots;
+    auto make = [](size_t index) { return std::make_unique<int>((int) index + 1); };
+    int &mine = slots.local(make);
+    ASSERT_EQ(&mine, &slots.local(make));
+    ASSERT_EQ(1, mine);
+    int *other = nullptr;
+    std::thread([&]() { other = &slots.local(make); }).join();
+    ASSERT_NE(&mine, other);
+    ASSERT_EQ(2, *other);
+    ASSERT_EQ(2u, slots.size());
+    int total = 0;
+    slots.forEach([&](int value) { total += value; });
+    ASSERT_EQ(3, total);
+}
+
+TEST(TestThreadSlots, TestFreshSlotPerOwner) {
+    // every owner gets a fresh slot, even where a destroyed one was allocated at the same address
+    for (int i = 0; i < 1000; ++i) {
+        ThreadSlots<int> slots;
+        slots.local() = i;
+        ASSERT_EQ(i, slots.local());
+        ASSERT_EQ(1u, slots.size());
+    }
+}
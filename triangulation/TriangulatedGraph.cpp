@@ -103,10 +103,10 @@ bool TriangulatedGraph::isValid() const {
 }
 
 bool TriangulatedGraph::operator==(const TriangulatedGraph &g) const {
-    assert(isValid() && g.isValid());
     if (size != g.getSize()) {
         return false;
     }
+    assert(isValid() && g.isValid());
     for (const Node &v1: vertices) {
         const Node *v2 = &g.vertices[v1.id];
         for (int neighbor: v1.neighbors) {
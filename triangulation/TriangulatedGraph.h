@@ -6,6 +6,7 @@
 #define FLIPDISTANCE_TRIANGULATEDGRAPH_H
 
 #include <set>
+#include <functional>
 #include "BinaryString.h"
 #include <vector>
 #include "BinaryTree.h"
@@ -0,0 +1,61 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "big_unsigned.h"
+#include <algorithm>
+
+BigUnsigned::BigUnsigned(uint64_t value) {
+    for (; value > 0; value >>= 32) {
+        limbs.push_back((uint32_t) value);
+    }
+}
+
+BigUnsigned &BigUnsigned::operator+=(const BigUnsigned &other) {
+    limbs.resize(std::max(limbs.size(), other.limbs.size()), 0);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < limbs.size(); ++i) {
+        carry += (uint64_t) limbs[i] + (i < other.limbs.size() ? other.limbs[i] : 0);
+        limbs[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+    if (carry > 0) {
+        limbs.push_back((uint32_t) carry);
+    }
+    return *this;
+}
+
+uint64_t BigUnsigned::toUint64() const {
+    uint64_t value = 0;
+    for (size_t i = std::min<size_t>(limbs.size(), 2); i-- > 0;) {
+        value = value << 32 | limbs[i];
+    }
+    return value;
+}
+
+std::string BigUnsigned::toString() const {
+    if (limbs.empty()) {
+        return "0";
+    }
+    // repeated division by 10^9, least significant chunk first
+    std::vector<uint32_t> rest = limbs;
+    std::vector<uint32_t> chunks;
+    while (!rest.empty()) {
+        uint64_t remainder = 0;
+        for (size_t i = rest.size(); i-- > 0;) {
+            uint64_t current = remainder << 32 | rest[i];
+            rest[i] = (uint32_t) (current / 1000000000);
+            remainder = current % 1000000000;
+        }
+        chunks.push_back((uint32_t) remainder);
+        while (!rest.empty() && rest.back() == 0) {
+            rest.pop_back();
+        }
+    }
+    std::string result = std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;) {
+        std::string digits = std::to_string(chunks[i]);
+        result += std::string(9 - digits.size(), '0') + digits;
+    }
+    return result;
+}
@@ -0,0 +1,46 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_BIG_UNSIGNED_H
+#define FLIPDISTANCE_BIG_UNSIGNED_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Unsigned integer of any size, with just the operations counting needs.
+class BigUnsigned {
+private:
+    // little endian base 2^32 digits, without leading zeros
+    std::vector<uint32_t> limbs;
+
+public:
+    BigUnsigned(uint64_t value = 0);
+
+    BigUnsigned &operator+=(const BigUnsigned &other);
+
+    bool operator==(const BigUnsigned &other) const {
+        return limbs == other.limbs;
+    }
+
+    bool operator!=(const BigUnsigned &other) const {
+        return limbs != other.limbs;
+    }
+
+    bool isZero() const {
+        return limbs.empty();
+    }
+
+    // Whether the value fits into 64 bits, and if so, the value.
+    bool fitsUint64() const {
+        return limbs.size() <= 2;
+    }
+
+    uint64_t toUint64() const;
+
+    // Decimal digits.
+    std::string toString() const;
+};
+
+#endif //FLIPDISTANCE_BIG_UNSIGNED_H
@@ -0,0 +1,87 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "bloom_filter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // finalizer of splitmix64
+    uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+}
+
+BlockedBloomFilter::BlockedBloomFilter(size_t bytes, unsigned int hashes)
+        : blocks(std::max<size_t>(1, bytes / sizeof(Block)), Block{}), hashes(std::max(1u, hashes)) {}
+
+unsigned int BlockedBloomFilter::hashesFor(double falsePositiveRate) {
+    double bits = -std::log2(std::min(std::max(falsePositiveRate, 1e-12), 0.5));
+    return (unsigned int) std::min(16.0, std::max(1.0, std::round(bits)));
+}
+
+bool BlockedBloomFilter::insert(uint64_t key) {
+    uint64_t h = mix(key);
+    uint64_t *block = blocks[h % blocks.size()].words;
+    // double hashing within the block's 512 bits
+    uint32_t a = (uint32_t) (h >> 32), b = (uint32_t) mix(h) | 1;
+    bool contained = true;
+    for (unsigned int i = 0; i < hashes; ++i) {
+        uint32_t bit = (a + i * b) & 511;
+        uint64_t mask = 1ull << (bit & 63);
+        if (!(block[bit >> 6] & mask)) {
+            contained = false;
+            block[bit >> 6] |= mask;
+        }
+    }
+    if (!contained) {
+        inserted++;
+    }
+    return contained;
+}
+
+bool BlockedBloomFilter::contains(uint64_t key) const {
+    uint64_t h = mix(key);
+    const uint64_t *block = blocks[h % blocks.size()].words;
+    uint32_t a = (uint32_t) (h >> 32), b = (uint32_t) mix(h) | 1;
+    for (unsigned int i = 0; i < hashes; ++i) {
+        uint32_t bit = (a + i * b) & 511;
+        if (!(block[bit >> 6] & (1ull << (bit & 63)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double BlockedBloomFilter::falsePositiveRate(size_t items) const {
+    double bits = (double) bytes() * 8;
+    return std::pow(1 - std::exp(-(double) hashes * (double) items / bits), hashes);
+}
+
+size_t BlockedBloomFilter::capacity(double rate) const {
+    // inverse of falsePositiveRate
+    double bits = (double) bytes() * 8;
+    double fill = std::pow(std::min(std::max(rate, 1e-300), 1.0), 1.0 / hashes);
+    if (fill >= 1) {
+        return SIZE_MAX;
+    }
+    return (size_t) (-std::log(1 - fill) * bits / hashes);
+}
+
+uint64_t hashBits(const std::vector<bool> &bits, uint64_t seed) {
+    uint64_t h = mix(seed + 0x9e3779b97f4a7c15ull), word = 0;
+    for (size_t i = 0; i < bits.size(); ++i) {
+        word |= (uint64_t) bits[i] << (i & 63);
+        if ((i & 63) == 63) {
+            h = mix(h ^ word);
+            word = 0;
+        }
+    }
+    return mix(h ^ word ^ bits.size());
+}
@@ -0,0 +1,57 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_BLOOM_FILTER_H
+#define FLIPDISTANCE_BLOOM_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Blocked Bloom filter: every key sets its bits within one 64 byte block, so a lookup touches a single cache
+// line. Keys are mixed before use, so any 64 bit hash will do. Not thread safe.
+class BlockedBloomFilter {
+private:
+    // aligned to the cache line it fills, so that no block straddles two
+    struct alignas(64) Block {
+        uint64_t words[8];
+    };
+
+    std::vector<Block> blocks;
+    unsigned int hashes;
+    size_t inserted = 0;
+
+public:
+    // bytes is rounded down to whole blocks, with at least one; hashes is the number of bits set per key
+    BlockedBloomFilter(size_t bytes, unsigned int hashes);
+
+    // Number of bits per key minimizing the size needed for falsePositiveRate.
+    static unsigned int hashesFor(double falsePositiveRate);
+
+    // Adds key; returns whether it may have been contained before.
+    bool insert(uint64_t key);
+
+    bool contains(uint64_t key) const;
+
+    size_t bytes() const {
+        return blocks.size() * sizeof(Block);
+    }
+
+    // Number of insertions of keys that were not contained yet.
+    size_t size() const {
+        return inserted;
+    }
+
+    // Expected false positive rate once items keys are inserted. Computed as for an unblocked filter, which
+    // slightly underestimates blocked ones.
+    double falsePositiveRate(size_t items) const;
+
+    // Number of keys that can be inserted before the expected false positive rate exceeds rate.
+    size_t capacity(double rate) const;
+};
+
+// 64 bit hash of bits, different for every seed.
+uint64_t hashBits(const std::vector<bool> &bits, uint64_t seed = 0);
+
+#endif //FLIPDISTANCE_BLOOM_FILTER_H
@@ -0,0 +1,148 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "checkpoint.h"
+#include <cstring>
+#include <filesystem>
+
+namespace {
+
+const uint32_t MAGIC = 0x4b434446; // "FDCK"
+const uint32_t VERSION = 1;
+
+}
+
+CheckpointWriter::CheckpointWriter(std::string path, const std::string &tag)
+        : path(std::move(path)), file(fopen((this->path + ".tmp").c_str(), "wb")), ok(file != nullptr) {
+    u32(MAGIC);
+    u32(VERSION);
+    u32((uint32_t) tag.size());
+    write(tag.data(), tag.size());
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    if (file != nullptr) {
+        fclose(file);
+        std::remove((path + ".tmp").c_str());
+    }
+}
+
+void CheckpointWriter::write(const void *data, size_t size) {
+    if (ok && size > 0) {
+        ok = fwrite(data, 1, size, file) == size;
+    }
+}
+
+void CheckpointWriter::u32(uint32_t value) {
+    write(&value, sizeof(value));
+}
+
+void CheckpointWriter::u64(uint64_t value) {
+    write(&value, sizeof(value));
+}
+
+void CheckpointWriter::bits(const std::vector<bool> &bits) {
+    uint64_t word = 0;
+    for (size_t i = 0; i < bits.size(); ++i) {
+        word |= (uint64_t) bits[i] << (i % 64);
+        if (i % 64 == 63) {
+            u64(word);
+            word = 0;
+        }
+    }
+    if (bits.size() % 64 != 0) {
+        u64(word);
+    }
+}
+
+void CheckpointWriter::sizedBits(const std::vector<bool> &bits) {
+    u64(bits.size());
+    this->bits(bits);
+}
+
+bool CheckpointWriter::commit() {
+    if (file == nullptr) {
+        return false;
+    }
+    ok = fclose(file) == 0 && ok;
+    file = nullptr;
+    std::string temporary = path + ".tmp";
+    if (ok) {
+        ok = std::rename(temporary.c_str(), path.c_str()) == 0;
+    }
+    if (!ok) {
+        std::remove(temporary.c_str());
+    }
+    return ok;
+}
+
+CheckpointReader::CheckpointReader(const std::string &path, const std::string &tag)
+        : file(fopen(path.c_str(), "rb")), ok(file != nullptr) {
+    if (u32() != MAGIC || u32() != VERSION || u32() != tag.size()) {
+        ok = false;
+        return;
+    }
+    std::string stored(tag.size(), '\0');
+    read(&stored[0], stored.size());
+    ok = ok && stored == tag;
+}
+
+CheckpointReader::~CheckpointReader() {
+    if (file != nullptr) {
+        fclose(file);
+    }
+}
+
+void CheckpointReader::read(void *data, size_t size) {
+    if (ok && size > 0) {
+        ok = fread(data, 1, size, file) == size;
+    }
+    if (!ok) {
+        memset(data, 0, size);
+    }
+}
+
+uint32_t CheckpointReader::u32() {
+    uint32_t value;
+    read(&value, sizeof(value));
+    return value;
+}
+
+uint64_t CheckpointReader::u64() {
+    uint64_t value;
+    read(&value, sizeof(value));
+    return value;
+}
+
+std::vector<bool> CheckpointReader::bits(size_t length) {
+    std::vector<bool> bits(length);
+    uint64_t word = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (i % 64 == 0) {
+            word = u64();
+        }
+        bits[i] = (word >> (i % 64)) & 1;
+    }
+    return bits;
+}
+
+std::vector<bool> CheckpointReader::sizedBits() {
+    uint64_t length = u64();
+    // a corrupt length must not turn into a huge allocation
+    if (!ok || length > (1u << 20)) {
+        ok = false;
+        return {};
+    }
+    return bits(length);
+}
+
+std::string checkpointPath(const std::string &directory, const std::string &tag) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    return (std::filesystem::path(directory) / (tag + ".ckpt")).string();
+}
+
+bool removeCheckpoint(const std::string &path) {
+    return std::remove(path.c_str()) == 0;
+}
@@ -0,0 +1,83 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_CHECKPOINT_H
+#define FLIPDISTANCE_CHECKPOINT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Binary snapshot writer. Data goes to path + ".tmp", which commit() renames over path, so the file at path
+// is always a complete snapshot even if the process dies while writing.
+class CheckpointWriter {
+private:
+    const std::string path;
+    FILE *file;
+    bool ok;
+
+    void write(const void *data, size_t size);
+
+public:
+    // Starts the file with a magic number, the format version and tag, which CheckpointReader checks.
+    CheckpointWriter(std::string path, const std::string &tag);
+
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter &) = delete;
+
+    CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+
+    void u32(uint32_t value);
+
+    void u64(uint64_t value);
+
+    // Packed into 64 bit words without a length; the reader has to know it.
+    void bits(const std::vector<bool> &bits);
+
+    // Length prefixed, for values whose size is not implied by the format.
+    void sizedBits(const std::vector<bool> &bits);
+
+    // False if anything could not be written; path is left untouched then.
+    bool commit();
+};
+
+class CheckpointReader {
+private:
+    FILE *file;
+    bool ok;
+
+    void read(void *data, size_t size);
+
+public:
+    // Fails (see good) if path is missing or was not written with the same tag and format version.
+    CheckpointReader(const std::string &path, const std::string &tag);
+
+    ~CheckpointReader();
+
+    CheckpointReader(const CheckpointReader &) = delete;
+
+    CheckpointReader &operator=(const CheckpointReader &) = delete;
+
+    uint32_t u32();
+
+    uint64_t u64();
+
+    std::vector<bool> bits(size_t length);
+
+    std::vector<bool> sizedBits();
+
+    // True while every read so far succeeded.
+    bool good() const {
+        return ok;
+    }
+};
+
+// Creates directory (and its parents) if needed and returns the path of the snapshot named tag inside it.
+std::string checkpointPath(const std::string &directory, const std::string &tag);
+
+bool removeCheckpoint(const std::string &path);
+
+#endif //FLIPDISTANCE_CHECKPOINT_H
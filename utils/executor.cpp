@@ -0,0 +1,75 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "executor.h"
+#include <algorithm>
+
+Executor::Executor(unsigned int threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned int i = 0; i < threads; ++i) {
+        workers.emplace_back(&Executor::work, this);
+    }
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (auto &worker: workers) {
+        worker.join();
+    }
+}
+
+void Executor::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    available.notify_one();
+}
+
+void Executor::forEachIndex(unsigned int count, const std::function<void(unsigned int)> &f) {
+    std::mutex doneMutex;
+    std::condition_variable doneChanged;
+    unsigned int done = 0;
+    for (unsigned int i = 1; i < count; ++i) {
+        submit([&, i]() {
+            f(i);
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (++done == count - 1) {
+                doneChanged.notify_all();
+            }
+        });
+    }
+    if (count > 0) {
+        f(0);
+    }
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneChanged.wait(lock, [&] { return done + 1 >= count; });
+}
+
+void Executor::work() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+Executor &Executor::shared() {
+    static Executor executor;
+    return executor;
+}
@@ -0,0 +1,50 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_EXECUTOR_H
+#define FLIPDISTANCE_EXECUTOR_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed size thread pool running tasks in submission order. Destruction waits for queued tasks.
+class Executor {
+private:
+    std::mutex mutex;
+    std::condition_variable available;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    void work();
+
+public:
+    // threads = 0 uses the hardware concurrency
+    explicit Executor(unsigned int threads = 0);
+
+    ~Executor();
+
+    Executor(const Executor &) = delete;
+
+    Executor &operator=(const Executor &) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Runs f(0) on the calling thread and f(1) .. f(count - 1) as tasks, and returns once all of them have. Tasks
+    // waiting in the queue delay it, so parallel loops want a pool of their own.
+    void forEachIndex(unsigned int count, const std::function<void(unsigned int)> &f);
+
+    size_t threadCount() const {
+        return workers.size();
+    }
+
+    // Process wide pool used by the asynchronous solve API.
+    static Executor &shared();
+};
+
+#endif //FLIPDISTANCE_EXECUTOR_H
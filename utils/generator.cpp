@@ -0,0 +1,74 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "generator.h"
+#include "rand.h"
+#include "../algo/flip_distance_bounds.h"
+#include "../algo/registry.h"
+
+std::vector<Edge> randomWalk(TriangulatedGraph &g, const TriangulatedGraph &origin, unsigned int steps) {
+    std::vector<Edge> walk;
+    for (unsigned int step = 0; step < steps; ++step) {
+        std::vector<Edge> spreading, neutral;
+        for (const Edge &e: g.getEdges()) {
+            Edge result = g.flip(e);
+            g.flip(result);
+            if (origin.hasEdge(result)) {
+                continue;
+            }
+            (origin.hasEdge(e) ? spreading : neutral).push_back(e);
+        }
+        std::vector<Edge> &pool = spreading.empty() ? neutral : spreading;
+        if (pool.empty()) {
+            break;
+        }
+        std::uniform_int_distribution<size_t> pick(0, pool.size() - 1);
+        Edge e = pool[pick(randomEngine())];
+        g.flip(e);
+        walk.push_back(e);
+    }
+    return walk;
+}
+
+// Distance certified by decisions within [lower, upper], where a walk of upper flips is known to exist. Engines
+// deciding by solving settle every k with their first decision.
+unsigned int solveDistance(FlipDistance &algo, unsigned int lower, unsigned int upper) {
+    for (unsigned int k = lower; k < upper;) {
+        FlipDistanceResult decision = algo.decideWithin(k, SearchLimits::none());
+        if (decision.exact) {
+            return decision.upperBound;
+        }
+        if (decision.upperBound <= k) {
+            return k;
+        }
+        k = std::max(k + 1, decision.lowerBound);
+    }
+    return upper;
+}
+
+std::optional<GeneratedInstance> generateInstance(int n, unsigned int minDistance, unsigned int maxDistance,
+                                                  const std::string &engine, int maxAttempts) {
+    const FlipDistanceFactory *factory = findExactEngine(engine);
+    if (factory == nullptr) {
+        return std::nullopt;
+    }
+    std::uniform_int_distribution<unsigned int> walkLength(minDistance, maxDistance);
+    for (int attempt = 0; attempt < maxAttempts; ++attempt) {
+        TriangulatedGraph start(randBits(n - 2)), end = start;
+        auto walk = randomWalk(end, start, walkLength(randomEngine()));
+        unsigned int lower = flipDistanceLowerBound(start, end);
+        unsigned int upper = std::min((unsigned int) walk.size(), flipDistanceUpperBound(start, end));
+        if (upper < minDistance || lower > maxDistance) {
+            continue;
+        }
+        if (lower == upper) {
+            return GeneratedInstance{start, end, lower, true};
+        }
+        unsigned int distance = solveDistance(*(*factory)(start, end), lower, upper);
+        if (minDistance <= distance && distance <= maxDistance) {
+            return GeneratedInstance{start, end, distance, false};
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,32 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_GENERATOR_H
+#define FLIPDISTANCE_GENERATOR_H
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "../triangulation/TriangulatedGraph.h"
+
+struct GeneratedInstance {
+    TriangulatedGraph start;
+    TriangulatedGraph end;
+    unsigned int distance;
+    // true if the lower bound met the length of the walk, so no solver was run
+    bool byConstruction;
+};
+
+// Walks g up to `steps` random flips away from origin. Flips that create a diagonal of origin are never taken
+// and flips that remove a diagonal shared with origin are preferred, so the lower bound grows whenever it can.
+// Returns the flipped diagonals in order; the walk stops early if every flip leads back towards origin.
+std::vector<Edge> randomWalk(TriangulatedGraph &g, const TriangulatedGraph &origin, unsigned int steps);
+
+// Generates a pair of n-gon triangulations whose exact flip distance lies in [minDistance, maxDistance].
+// The distance is certified either by construction (lower bound == walk length) or by deciding with `engine`,
+// which has to be one of the exact engines of flipDistanceEngines; empty for any other name.
+std::optional<GeneratedInstance> generateInstance(int n, unsigned int minDistance, unsigned int maxDistance,
+                                                  const std::string &engine = "source", int maxAttempts = 1000);
+
+#endif //FLIPDISTANCE_GENERATOR_H
@@ -0,0 +1,292 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "memory.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+thread_local MemoryCategory currentCategory = MemoryCategory::Other;
+
+struct CategoryCounters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> liveBytes{0};
+    std::atomic<uint64_t> peakLiveBytes{0};
+};
+
+CategoryCounters counters[(int) MemoryCategory::Count];
+
+uint64_t readStatusKb(const char *key) {
+    FILE *f = fopen("/proc/self/status", "r");
+    if (f == nullptr) {
+        return 0;
+    }
+    char line[256];
+    uint64_t result = 0;
+    size_t keyLength = strlen(key);
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, key, keyLength) == 0 && line[keyLength] == ':') {
+            result = strtoull(line + keyLength + 1, nullptr, 10);
+            break;
+        }
+    }
+    fclose(f);
+    return result;
+}
+
+}
+
+MemoryCategoryScope::MemoryCategoryScope(MemoryCategory category) : previous(currentCategory) {
+    currentCategory = category;
+}
+
+MemoryCategoryScope::~MemoryCategoryScope() {
+    currentCategory = previous;
+}
+
+const char *memoryCategoryName(MemoryCategory category) {
+    switch (category) {
+        case MemoryCategory::Other:
+            return "other";
+        case MemoryCategory::Visited:
+            return "visited";
+        case MemoryCategory::Frontier:
+            return "frontier";
+        case MemoryCategory::Sources:
+            return "sources";
+        case MemoryCategory::Subproblems:
+            return "subproblems";
+        default:
+            return "unknown";
+    }
+}
+
+uint64_t peakResidentSetKb() {
+    return readStatusKb("VmHWM");
+}
+
+uint64_t liveHeapBytes() {
+    uint64_t total = 0;
+    for (const auto &c: counters) {
+        total += c.liveBytes.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+MemoryReport memoryReport() {
+    MemoryReport report;
+    report.accounting = memoryAccountingEnabled();
+    for (int i = 0; i < (int) MemoryCategory::Count; ++i) {
+        report.categories[i].allocations = counters[i].allocations.load(std::memory_order_relaxed);
+        report.categories[i].bytes = counters[i].bytes.load(std::memory_order_relaxed);
+        report.categories[i].liveBytes = counters[i].liveBytes.load(std::memory_order_relaxed);
+        report.categories[i].peakLiveBytes = counters[i].peakLiveBytes.load(std::memory_order_relaxed);
+    }
+    report.peakResidentKb = readStatusKb("VmHWM");
+    report.residentKb = readStatusKb("VmRSS");
+    return report;
+}
+
+std::string MemoryReport::toString() const {
+    std::string res = "peakRssKb=" + std::to_string(peakResidentKb) + " rssKb=" + std::to_string(residentKb);
+    if (!accounting) {
+        return res;
+    }
+    for (int i = 0; i < (int) MemoryCategory::Count; ++i) {
+        const CategoryUsage &usage = categories[i];
+        res += std::string(" ") + memoryCategoryName((MemoryCategory) i) + "=" +
+               std::to_string(usage.allocations) + "/" + std::to_string(usage.bytes) + "/" +
+               std::to_string(usage.peakLiveBytes);
+    }
+    return res;
+}
+
+#ifdef FLIP_DISTANCE_MEMORY_ACCOUNTING
+
+bool memoryAccountingEnabled() {
+    return true;
+}
+
+namespace {
+
+// Every block is prefixed with its size and category so that frees are charged to the right category.
+struct alignas(std::max_align_t) BlockHeader {
+    uint64_t size;
+    int category;
+};
+
+// Fills in header and counts a block of size bytes behind it.
+void *countBlock(BlockHeader *header, std::size_t size) {
+    int category = (int) currentCategory;
+    header->size = size;
+    header->category = category;
+    CategoryCounters &c = counters[category];
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.bytes.fetch_add(size, std::memory_order_relaxed);
+    uint64_t live = c.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = c.peakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !c.peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return header + 1;
+}
+
+BlockHeader *uncountBlock(void *p) {
+    BlockHeader *header = (BlockHeader *) p - 1;
+    counters[header->category].liveBytes.fetch_sub(header->size, std::memory_order_relaxed);
+    return header;
+}
+
+void *countedAllocate(std::size_t size) {
+    auto *header = (BlockHeader *) std::malloc(sizeof(BlockHeader) + size);
+    if (header == nullptr) {
+        return nullptr;
+    }
+    return countBlock(header, size);
+}
+
+void countedFree(void *p) {
+    if (p == nullptr) {
+        return;
+    }
+    std::free(uncountBlock(p));
+}
+
+// Over-aligned blocks start a whole number of alignments into their allocation, which leaves room for the header
+// and, before it, the start of the allocation to free.
+std::size_t alignedOffset(std::size_t alignment) {
+    std::size_t needed = sizeof(BlockHeader) + sizeof(void *);
+    return (needed + alignment - 1) / alignment * alignment;
+}
+
+void *countedAllocateAligned(std::size_t size, std::align_val_t align) {
+    std::size_t alignment = std::max((std::size_t) align, alignof(BlockHeader));
+    std::size_t offset = alignedOffset(alignment);
+    void *base;
+    if (posix_memalign(&base, alignment, offset + size) != 0) {
+        return nullptr;
+    }
+    auto *header = (BlockHeader *) ((char *) base + offset) - 1;
+    ((void **) header)[-1] = base;
+    return countBlock(header, size);
+}
+
+void countedFreeAligned(void *p) {
+    if (p == nullptr) {
+        return;
+    }
+    std::free(((void **) uncountBlock(p))[-1]);
+}
+
+void *allocateOrThrow(std::size_t size) {
+    void *p = countedAllocate(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *allocateAlignedOrThrow(std::size_t size, std::align_val_t align) {
+    void *p = countedAllocateAligned(size, align);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+}
+
+void *operator new(std::size_t size) {
+    return allocateOrThrow(size);
+}
+
+void *operator new[](std::size_t size) {
+    return allocateOrThrow(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return countedAllocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return countedAllocate(size);
+}
+
+void operator delete(void *p) noexcept {
+    countedFree(p);
+}
+
+void operator delete[](void *p) noexcept {
+    countedFree(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    countedFree(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    countedFree(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+    countedFree(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+    countedFree(p);
+}
+
+void *operator new(std::size_t size, std::align_val_t align) {
+    return allocateAlignedOrThrow(size, align);
+}
+
+void *operator new[](std::size_t size, std::align_val_t align) {
+    return allocateAlignedOrThrow(size, align);
+}
+
+void *operator new(std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    return countedAllocateAligned(size, align);
+}
+
+void *operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    return countedAllocateAligned(size, align);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept {
+    countedFreeAligned(p);
+}
+
+void operator delete[](void *p, std::align_val_t) noexcept {
+    countedFreeAligned(p);
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+    countedFreeAligned(p);
+}
+
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept {
+    countedFreeAligned(p);
+}
+
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept {
+    countedFreeAligned(p);
+}
+
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept {
+    countedFreeAligned(p);
+}
+
+#else
+
+bool memoryAccountingEnabled() {
+    return false;
+}
+
+#endif
@@ -0,0 +1,60 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_MEMORY_H
+#define FLIPDISTANCE_MEMORY_H
+
+#include <cstdint>
+#include <string>
+
+// Call site categories for allocation accounting. Allocations are charged to the category of the
+// innermost MemoryCategoryScope on the allocating thread.
+enum class MemoryCategory {
+    Other, Visited, Frontier, Sources, Subproblems, Count
+};
+
+struct CategoryUsage {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    uint64_t liveBytes = 0;
+    uint64_t peakLiveBytes = 0;
+};
+
+struct MemoryReport {
+    bool accounting = false;
+    CategoryUsage categories[(int) MemoryCategory::Count];
+    // from /proc/self/status, 0 where unavailable
+    uint64_t peakResidentKb = 0;
+    uint64_t residentKb = 0;
+
+    std::string toString() const;
+};
+
+class MemoryCategoryScope {
+private:
+    const MemoryCategory previous;
+
+public:
+    explicit MemoryCategoryScope(MemoryCategory category);
+
+    ~MemoryCategoryScope();
+
+    MemoryCategoryScope(const MemoryCategoryScope &) = delete;
+
+    MemoryCategoryScope &operator=(const MemoryCategoryScope &) = delete;
+};
+
+// True if built with FLIP_DISTANCE_MEMORY_ACCOUNTING, i.e. the global allocator is replaced by a counting one.
+bool memoryAccountingEnabled();
+
+MemoryReport memoryReport();
+
+// Live heap bytes over all categories; always 0 without FLIP_DISTANCE_MEMORY_ACCOUNTING.
+uint64_t liveHeapBytes();
+
+uint64_t peakResidentSetKb();
+
+const char *memoryCategoryName(MemoryCategory category);
+
+#endif //FLIPDISTANCE_MEMORY_H
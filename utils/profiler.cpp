@@ -0,0 +1,210 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "profiler.h"
+#include <cstdio>
+#include <ctime>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+double threadCpuSeconds() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+// One perf_event group per thread, opened on first use. Counts user space only so that it works
+// with the default perf_event_paranoid setting.
+class CounterGroup {
+private:
+    int fds[HardwareCounterCount]{-1, -1, -1, -1};
+    bool available = false;
+
+public:
+    CounterGroup() {
+#ifdef __linux__
+        const uint64_t configs[HardwareCounterCount] = {
+                PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+        for (int i = 0; i < HardwareCounterCount; ++i) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.disabled = i == 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            fds[i] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0);
+            if (fds[i] < 0) {
+                return;
+            }
+        }
+        ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        available = true;
+#endif
+    }
+
+    ~CounterGroup() {
+#ifdef __linux__
+        for (int fd: fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    bool read(uint64_t values[HardwareCounterCount]) const {
+#ifdef __linux__
+        if (!available) {
+            return false;
+        }
+        uint64_t buffer[1 + HardwareCounterCount];
+        if (::read(fds[0], buffer, sizeof(buffer)) != (ssize_t) sizeof(buffer)) {
+            return false;
+        }
+        for (int i = 0; i < HardwareCounterCount; ++i) {
+            values[i] = buffer[1 + i];
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static const CounterGroup &local() {
+        thread_local CounterGroup group;
+        return group;
+    }
+};
+
+thread_local int phaseNesting[(int) Phase::Count]{};
+
+}
+
+void Profiler::record(Phase phase, const PhaseTotals &measurement) {
+    auto add = [](std::atomic<uint64_t> &counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    };
+    ThreadPhaseTotals::Counts &total = threads.local().phases[(int) phase];
+    add(total.calls, measurement.calls);
+    add(total.wallNs, (uint64_t) (measurement.wallSeconds * 1e9));
+    add(total.cpuNs, (uint64_t) (measurement.cpuSeconds * 1e9));
+    if (measurement.hasCounters) {
+        total.hasCounters.store(true, std::memory_order_relaxed);
+        for (int i = 0; i < HardwareCounterCount; ++i) {
+            add(total.counters[i], measurement.counters[i]);
+        }
+    }
+}
+
+PhaseTotals Profiler::getTotals(Phase phase) const {
+    PhaseTotals result;
+    uint64_t wallNs = 0, cpuNs = 0;
+    threads.forEach([&](const ThreadPhaseTotals &thread) {
+        const ThreadPhaseTotals::Counts &total = thread.phases[(int) phase];
+        result.calls += total.calls.load(std::memory_order_relaxed);
+        wallNs += total.wallNs.load(std::memory_order_relaxed);
+        cpuNs += total.cpuNs.load(std::memory_order_relaxed);
+        if (total.hasCounters.load(std::memory_order_relaxed)) {
+            result.hasCounters = true;
+            for (int i = 0; i < HardwareCounterCount; ++i) {
+                result.counters[i] += total.counters[i].load(std::memory_order_relaxed);
+            }
+        }
+    });
+    result.wallSeconds = (double) wallNs * 1e-9;
+    result.cpuSeconds = (double) cpuNs * 1e-9;
+    return result;
+}
+
+const char *Profiler::phaseName(Phase phase) {
+    switch (phase) {
+        case Phase::Parsing:
+            return "parsing";
+        case Phase::Conversion:
+            return "conversion";
+        case Phase::Sources:
+            return "getSources";
+        case Phase::Search:
+            return "search";
+        case Phase::Split:
+            return "split";
+        case Phase::FinalCheck:
+            return "finalCheck";
+        default:
+            return "unknown";
+    }
+}
+
+std::string Profiler::report() const {
+    std::string res;
+    char line[256];
+    snprintf(line, sizeof(line), "%-11s %10s %10s %10s %14s %14s %6s %12s %12s\n", "phase", "calls", "wall(s)",
+             "cpu(s)", "cycles", "instructions", "IPC", "cacheMisses", "branchMisses");
+    res += line;
+    for (int i = 0; i < (int) Phase::Count; ++i) {
+        PhaseTotals t = getTotals((Phase) i);
+        if (t.calls == 0) {
+            continue;
+        }
+        snprintf(line, sizeof(line), "%-11s %10llu %10.4f %10.4f ", phaseName((Phase) i),
+                 (unsigned long long) t.calls, t.wallSeconds, t.cpuSeconds);
+        res += line;
+        if (t.hasCounters) {
+            snprintf(line, sizeof(line), "%14llu %14llu %6.2f %12llu %12llu\n",
+                     (unsigned long long) t.counters[Cycles], (unsigned long long) t.counters[Instructions],
+                     t.counters[Cycles] ? (double) t.counters[Instructions] / (double) t.counters[Cycles] : 0.0,
+                     (unsigned long long) t.counters[CacheMisses], (unsigned long long) t.counters[BranchMisses]);
+        } else {
+            snprintf(line, sizeof(line), "%14s %14s %6s %12s %12s\n", "n/a", "n/a", "n/a", "n/a", "n/a");
+        }
+        res += line;
+    }
+    return res;
+}
+
+ScopedPhase::ScopedPhase(Profiler *profiler, Phase phase) : profiler(profiler), phase(phase) {
+    if (profiler == nullptr || phaseNesting[(int) phase]++ > 0) {
+        return;
+    }
+    outermost = true;
+    // the final check runs once per node; reading counters there would cost more than the check itself
+    if (profiler->usesHardwareCounters() && phase != Phase::FinalCheck) {
+        hasCounters = CounterGroup::local().read(countersStart);
+    }
+    cpuStart = threadCpuSeconds();
+    wallStart = std::chrono::steady_clock::now();
+}
+
+ScopedPhase::~ScopedPhase() {
+    if (profiler == nullptr) {
+        return;
+    }
+    phaseNesting[(int) phase]--;
+    if (!outermost) {
+        return;
+    }
+    PhaseTotals measurement;
+    measurement.calls = 1;
+    measurement.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    measurement.cpuSeconds = threadCpuSeconds() - cpuStart;
+    uint64_t countersEnd[HardwareCounterCount];
+    if (hasCounters && CounterGroup::local().read(countersEnd)) {
+        measurement.hasCounters = true;
+        for (int i = 0; i < HardwareCounterCount; ++i) {
+            measurement.counters[i] = countersEnd[i] - countersStart[i];
+        }
+    }
+    profiler->record(phase, measurement);
+}
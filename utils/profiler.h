@@ -0,0 +1,92 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_PROFILER_H
+#define FLIPDISTANCE_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "thread_slots.h"
+
+enum class Phase {
+    Parsing, Conversion, Sources, Search, Split, FinalCheck, Count
+};
+
+enum HardwareCounter {
+    Cycles, Instructions, CacheMisses, BranchMisses, HardwareCounterCount
+};
+
+struct PhaseTotals {
+    uint64_t calls = 0;
+    double wallSeconds = 0;
+    double cpuSeconds = 0;
+    // only filled when the phase was measured with perf_event_open counters
+    bool hasCounters = false;
+    uint64_t counters[HardwareCounterCount]{};
+};
+
+// Totals of one thread, written by it only, so the hot path takes no lock; times are in nanoseconds.
+struct ThreadPhaseTotals {
+    struct Counts {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> wallNs{0};
+        std::atomic<uint64_t> cpuNs{0};
+        std::atomic<bool> hasCounters{false};
+        std::atomic<uint64_t> counters[HardwareCounterCount]{};
+    };
+
+    Counts phases[(int) Phase::Count];
+};
+
+// Collects wall time, thread CPU time and (on Linux, where perf_event_open is permitted) hardware counters
+// per phase. Nested occurrences of the same phase on one thread are only measured at the outermost level,
+// so recursive splits are not counted twice.
+class Profiler {
+private:
+    const bool hardwareCounters;
+    // merged when the totals are read
+    ThreadSlots<ThreadPhaseTotals> threads;
+
+public:
+    explicit Profiler(bool hardwareCounters = true) : hardwareCounters(hardwareCounters) {}
+
+    bool usesHardwareCounters() const {
+        return hardwareCounters;
+    }
+
+    // Adds measurement to the calling thread's totals.
+    void record(Phase phase, const PhaseTotals &measurement);
+
+    PhaseTotals getTotals(Phase phase) const;
+
+    // Human readable table, one line per phase that was entered at least once.
+    std::string report() const;
+
+    static const char *phaseName(Phase phase);
+};
+
+// Measures the enclosing scope as one occurrence of `phase`. Does nothing if profiler is null.
+class ScopedPhase {
+private:
+    Profiler *const profiler;
+    const Phase phase;
+    bool outermost = false;
+    bool hasCounters = false;
+    std::chrono::steady_clock::time_point wallStart;
+    double cpuStart = 0;
+    uint64_t countersStart[HardwareCounterCount]{};
+
+public:
+    ScopedPhase(Profiler *profiler, Phase phase);
+
+    ~ScopedPhase();
+
+    ScopedPhase(const ScopedPhase &) = delete;
+
+    ScopedPhase &operator=(const ScopedPhase &) = delete;
+};
+
+#endif //FLIPDISTANCE_PROFILER_H
@@ -0,0 +1,97 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "radix_sort.h"
+#include <algorithm>
+#include <array>
+#include <thread>
+
+namespace {
+    const int DIGIT_BITS = 8;
+    const size_t BUCKETS = 1 << DIGIT_BITS;
+    // below this many keys starting threads costs more than it saves
+    const size_t PARALLEL_THRESHOLD = 1 << 16;
+
+    // Runs f(thread, begin, end) on threads equal slices of [0, size), the first one on the calling thread.
+    template<class F>
+    void forSlices(size_t size, unsigned int threads, Executor *pool, const F &f) {
+        if (pool != nullptr) {
+            pool->forEachIndex(threads, [&](unsigned int t) { f(t, size * t / threads, size * (t + 1) / threads); });
+            return;
+        }
+        std::vector<std::thread> workers;
+        for (unsigned int t = 1; t < threads; ++t) {
+            workers.emplace_back(f, t, size * t / threads, size * (t + 1) / threads);
+        }
+        f(0, 0, size / threads);
+        for (auto &worker: workers) {
+            worker.join();
+        }
+    }
+}
+
+void radixSort(std::vector<uint64_t> &keys, unsigned int threads, Executor *pool) {
+    if (keys.size() < 2) {
+        return;
+    }
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (keys.size() < PARALLEL_THRESHOLD) {
+        threads = 1;
+    }
+    uint64_t varying = 0;
+    for (uint64_t key: keys) {
+        varying |= key ^ keys[0];
+    }
+    std::vector<uint64_t> buffer(keys.size());
+    std::vector<std::array<size_t, BUCKETS>> counts(threads);
+    for (int shift = 0; shift < 64; shift += DIGIT_BITS) {
+        if (((varying >> shift) & (BUCKETS - 1)) == 0) {
+            continue;
+        }
+        forSlices(keys.size(), threads, pool, [&](unsigned int t, size_t begin, size_t end) {
+            std::array<size_t, BUCKETS> &count = counts[t];
+            count.fill(0);
+            for (size_t i = begin; i < end; ++i) {
+                count[(keys[i] >> shift) & (BUCKETS - 1)]++;
+            }
+        });
+        // every thread scatters its slice of a bucket behind the slices of the threads before it,
+        // which keeps the sort stable
+        size_t offset = 0;
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            for (auto &count: counts) {
+                size_t n = count[b];
+                count[b] = offset;
+                offset += n;
+            }
+        }
+        forSlices(keys.size(), threads, pool, [&](unsigned int t, size_t begin, size_t end) {
+            std::array<size_t, BUCKETS> &next = counts[t];
+            for (size_t i = begin; i < end; ++i) {
+                buffer[next[(keys[i] >> shift) & (BUCKETS - 1)]++] = keys[i];
+            }
+        });
+        keys.swap(buffer);
+    }
+}
+
+void radixSortUnique(std::vector<uint64_t> &keys, unsigned int threads, Executor *pool) {
+    radixSort(keys, threads, pool);
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+void removeSorted(std::vector<uint64_t> &keys, const std::vector<uint64_t> &sorted) {
+    size_t kept = 0, j = 0;
+    for (uint64_t key: keys) {
+        while (j < sorted.size() && sorted[j] < key) {
+            ++j;
+        }
+        if (j == sorted.size() || sorted[j] != key) {
+            keys[kept++] = key;
+        }
+    }
+    keys.resize(kept);
+}
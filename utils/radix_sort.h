@@ -0,0 +1,25 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_RADIX_SORT_H
+#define FLIPDISTANCE_RADIX_SORT_H
+
+#include <cstdint>
+#include <vector>
+#include "executor.h"
+
+// Sorts keys with a least significant digit radix sort, 8 bits per pass. Every pass streams through the keys
+// once on each thread's slice: the threads count digits, and after a prefix sum scatter into disjoint ranges of
+// a buffer. Passes over digits that are the same in every key are skipped.
+// threads = 0 uses the hardware concurrency. The slices run on pool if given, on threads started per pass
+// otherwise.
+void radixSort(std::vector<uint64_t> &keys, unsigned int threads = 0, Executor *pool = nullptr);
+
+// Sorts keys and removes duplicates.
+void radixSortUnique(std::vector<uint64_t> &keys, unsigned int threads = 0, Executor *pool = nullptr);
+
+// Removes from sorted keys every key contained in sorted, in one merge pass over both.
+void removeSorted(std::vector<uint64_t> &keys, const std::vector<uint64_t> &sorted);
+
+#endif //FLIPDISTANCE_RADIX_SORT_H
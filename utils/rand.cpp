@@ -6,14 +6,22 @@
 #include <vector>
 #include <random>
 
-bool randBool() {
+std::mt19937 &randomEngine() {
     static std::random_device rd;
     static std::mt19937 mt(rd());
-    static std::uniform_int_distribution<int> dist(0, 1);
-    return (bool) dist(mt);
+    return mt;
+}
+
+void seedRandom(unsigned int seed) {
+    randomEngine().seed(seed);
 }
 
 std::vector<bool> randBits(int n) {
+    return randBits(n, randomEngine());
+}
+
+std::vector<bool> randBits(int n, std::mt19937 &mt) {
+    std::uniform_int_distribution<int> dist(0, 1);
     std::vector<bool> result;
     int totalTrue = 0;
     int currTrue = 0;
@@ -24,7 +32,7 @@ std::vector<bool> randBits(int n) {
         } else if (totalTrue == n) {
             bit = false;
         } else {
-            bit = randBool();
+            bit = (bool) dist(mt);
         }
         result.push_back(bit);
         totalTrue += bit;
@@ -5,9 +5,21 @@
 #ifndef FLIPDISTANCE_RAND_H
 #define FLIPDISTANCE_RAND_H
 
+#include <random>
 #include <utility>
+#include <vector>
 #include "../triangulation/TriangulatedGraph.h"
 
+std::mt19937 &randomEngine();
+
+// Makes every following random triangulation reproducible.
+void seedRandom(unsigned int seed);
+
+std::vector<bool> randBits(int n);
+
+// Same as randBits, drawing from mt instead of the shared engine; safe to use from several threads.
+std::vector<bool> randBits(int n, std::mt19937 &mt);
+
 std::pair<TriangulatedGraph, TriangulatedGraph> randomTriangulation(int n, bool noSimple = true);
 
 #endif //FLIPDISTANCE_RAND_H
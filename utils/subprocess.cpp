@@ -0,0 +1,148 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "subprocess.h"
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+namespace {
+    bool writeAll(int fd, const void *data, size_t size) {
+        const char *bytes = (const char *) data;
+        while (size > 0) {
+            ssize_t written = ::write(fd, bytes, size);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                return false;
+            }
+            bytes += written;
+            size -= (size_t) written;
+        }
+        return true;
+    }
+
+    // Blocks SIGPIPE on the calling thread for its scope, so that writing to a pipe whose reader died fails with
+    // EPIPE instead of killing the process, without touching the process wide disposition. A SIGPIPE raised
+    // meanwhile is consumed before the mask is restored, unless one was pending already.
+    class SigpipeBlock {
+    private:
+        sigset_t pipeSignal, previous;
+        bool pending;
+
+    public:
+        SigpipeBlock() {
+            sigemptyset(&pipeSignal);
+            sigaddset(&pipeSignal, SIGPIPE);
+            sigset_t signals;
+            sigpending(&signals);
+            pending = sigismember(&signals, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &pipeSignal, &previous);
+        }
+
+        ~SigpipeBlock() {
+            sigset_t signals;
+            sigpending(&signals);
+            if (!pending && sigismember(&signals, SIGPIPE)) {
+                timespec zero{0, 0};
+                while (sigtimedwait(&pipeSignal, nullptr, &zero) < 0 && errno == EINTR) {}
+            }
+            pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+        }
+    };
+
+    bool readAll(int fd, void *data, size_t size) {
+        char *bytes = (char *) data;
+        while (size > 0) {
+            ssize_t read = ::read(fd, bytes, size);
+            if (read < 0 && errno == EINTR) {
+                continue;
+            }
+            if (read <= 0) {
+                return false;
+            }
+            bytes += read;
+            size -= (size_t) read;
+        }
+        return true;
+    }
+}
+
+bool writeMessage(int fd, const std::vector<uint64_t> &message) {
+    SigpipeBlock block;
+    uint64_t size = message.size();
+    return writeAll(fd, &size, sizeof(size)) && writeAll(fd, message.data(), size * sizeof(uint64_t));
+}
+
+bool readMessage(int fd, std::vector<uint64_t> &message) {
+    uint64_t size;
+    if (!readAll(fd, &size, sizeof(size))) {
+        return false;
+    }
+    message.resize(size);
+    return readAll(fd, message.data(), size * sizeof(uint64_t));
+}
+
+Subprocess::Subprocess(const std::function<int(int, int)> &body) {
+    int toChild[2], fromChild[2];
+    if (pipe(toChild) != 0) {
+        return;
+    }
+    if (pipe(fromChild) != 0) {
+        close(toChild[0]);
+        close(toChild[1]);
+        return;
+    }
+    pid = fork();
+    if (pid == 0) {
+        // later children inherit the pipes of earlier ones, so end of file cannot tell them the parent is gone
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        close(toChild[1]);
+        close(fromChild[0]);
+        int status = body(toChild[0], fromChild[1]);
+        _exit(status);
+    }
+    close(toChild[0]);
+    close(fromChild[1]);
+    if (pid < 0) {
+        close(toChild[1]);
+        close(fromChild[0]);
+        return;
+    }
+    output = toChild[1];
+    input = fromChild[0];
+}
+
+Subprocess::~Subprocess() {
+    if (running()) {
+        kill(pid, SIGKILL);
+        wait();
+    }
+}
+
+bool Subprocess::send(const std::vector<uint64_t> &message) {
+    return running() && writeMessage(output, message);
+}
+
+bool Subprocess::receive(std::vector<uint64_t> &message) {
+    return running() && readMessage(input, message);
+}
+
+int Subprocess::wait() {
+    if (!running()) {
+        return -1;
+    }
+    close(output);
+    close(input);
+    output = input = -1;
+    int status;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    pid = -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
@@ -0,0 +1,53 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_SUBPROCESS_H
+#define FLIPDISTANCE_SUBPROCESS_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <sys/types.h>
+
+// Child process forked from the calling one, talking to its parent through a pair of pipes. The child starts
+// with a copy of the parent's memory, so body may use anything set up before; it should not rely on threads of
+// the parent, which do not exist in the child.
+class Subprocess {
+private:
+    pid_t pid = -1;
+    // parent's ends of the pipes
+    int input = -1, output = -1;
+
+public:
+    // Runs body(in, out) in the child, which then exits with its result without unwinding the parent's stack.
+    // See running for whether the process could be started.
+    explicit Subprocess(const std::function<int(int in, int out)> &body);
+
+    // Kills the child if it is still running.
+    ~Subprocess();
+
+    Subprocess(const Subprocess &) = delete;
+
+    Subprocess &operator=(const Subprocess &) = delete;
+
+    bool running() const {
+        return pid > 0;
+    }
+
+    bool send(const std::vector<uint64_t> &message);
+
+    // False once the child has exited or the pipe broke.
+    bool receive(std::vector<uint64_t> &message);
+
+    // Closes the pipes and waits for the child to exit; returns its exit status, or -1 if it did not exit normally.
+    int wait();
+};
+
+// Length prefixed messages of 64 bit words, used on both ends of a Subprocess. Writing to a pipe whose reader is
+// gone returns false rather than raising SIGPIPE.
+bool writeMessage(int fd, const std::vector<uint64_t> &message);
+
+bool readMessage(int fd, std::vector<uint64_t> &message);
+
+#endif //FLIPDISTANCE_SUBPROCESS_H
@@ -0,0 +1,83 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "thread_slots.h"
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+struct LiveOwners {
+    std::mutex mutex;
+    std::unordered_set<uint64_t> ids;
+    // owners destroyed so far, to skip pruning while none was
+    std::atomic<uint64_t> destroyed{0};
+    std::atomic<uint64_t> next{0};
+
+    static LiveOwners &get() {
+        static LiveOwners owners;
+        return owners;
+    }
+};
+
+struct SlotCache {
+    // ids are never reused, so the last entry can be kept until another owner is looked up
+    uint64_t lastId = UINT64_MAX;
+    void *last = nullptr;
+    uint64_t prunedAt = 0;
+    std::unordered_map<uint64_t, void *> slots;
+
+    void prune() {
+        LiveOwners &owners = LiveOwners::get();
+        uint64_t destroyed = owners.destroyed.load(std::memory_order_acquire);
+        if (destroyed == prunedAt) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(owners.mutex);
+        for (auto it = slots.begin(); it != slots.end();) {
+            it = owners.ids.count(it->first) ? std::next(it) : slots.erase(it);
+        }
+        prunedAt = destroyed;
+    }
+};
+
+thread_local SlotCache slotCache;
+
+}
+
+ThreadSlotOwner::ThreadSlotOwner() : id(LiveOwners::get().next++) {
+    LiveOwners &owners = LiveOwners::get();
+    std::lock_guard<std::mutex> lock(owners.mutex);
+    owners.ids.insert(id);
+}
+
+ThreadSlotOwner::~ThreadSlotOwner() {
+    LiveOwners &owners = LiveOwners::get();
+    std::lock_guard<std::mutex> lock(owners.mutex);
+    owners.ids.erase(id);
+    owners.destroyed.fetch_add(1, std::memory_order_release);
+}
+
+void *ThreadSlotOwner::cached() const {
+    SlotCache &cache = slotCache;
+    if (cache.lastId == id) {
+        return cache.last;
+    }
+    auto find = cache.slots.find(id);
+    if (find == cache.slots.end()) {
+        return nullptr;
+    }
+    cache.lastId = id;
+    cache.last = find->second;
+    return cache.last;
+}
+
+void ThreadSlotOwner::cache(void *slot) const {
+    SlotCache &cache = slotCache;
+    cache.prune();
+    cache.slots[id] = slot;
+    cache.lastId = id;
+    cache.last = slot;
+}
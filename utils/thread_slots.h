@@ -0,0 +1,82 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_THREAD_SLOTS_H
+#define FLIPDISTANCE_THREAD_SLOTS_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Identity of an owner of per-thread slots. Every thread caches the slot it was given per owner; the entries of
+// destroyed owners are pruned the next time the thread takes a slot of an owner it has not seen, so the cache of
+// a long-lived thread only holds the owners still alive.
+class ThreadSlotOwner {
+private:
+    const uint64_t id;
+
+protected:
+    ThreadSlotOwner();
+
+    ~ThreadSlotOwner();
+
+    // Slot of the calling thread, or null if it has none yet.
+    void *cached() const;
+
+    void cache(void *slot) const;
+
+public:
+    ThreadSlotOwner(const ThreadSlotOwner &) = delete;
+
+    ThreadSlotOwner &operator=(const ThreadSlotOwner &) = delete;
+};
+
+// One T per thread that used it, for state written by its thread only and read by any. The slots live as long
+// as the owner.
+template<typename T>
+class ThreadSlots : private ThreadSlotOwner {
+private:
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<T>> slots;
+
+public:
+    ThreadSlots() = default;
+
+    // Slot of the calling thread, made by make(index) the first time, where index counts the slots before.
+    template<typename Make>
+    T &local(Make make) {
+        if (void *slot = cached()) {
+            return *static_cast<T *>(slot);
+        }
+        T *slot;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            slots.push_back(make(slots.size()));
+            slot = slots.back().get();
+        }
+        cache(slot);
+        return *slot;
+    }
+
+    T &local() {
+        return local([](size_t) { return std::make_unique<T>(); });
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return slots.size();
+    }
+
+    // Calls f on every slot, holding off new ones meanwhile.
+    template<typename F>
+    void forEach(F f) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto &slot: slots) {
+            f(*slot);
+        }
+    }
+};
+
+#endif //FLIPDISTANCE_THREAD_SLOTS_H
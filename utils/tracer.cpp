@@ -0,0 +1,77 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#include "tracer.h"
+#include <cstdio>
+
+std::vector<TraceEvent> TraceBuffer::collect() const {
+    uint64_t h = head.load(std::memory_order_acquire);
+    uint64_t first = h > events.size() ? h - events.size() : 0;
+    std::vector<TraceEvent> result;
+    for (uint64_t i = first; i < h; ++i) {
+        result.push_back(events[i & mask]);
+    }
+    return result;
+}
+
+uint64_t TraceBuffer::dropped() const {
+    uint64_t h = head.load(std::memory_order_acquire);
+    return h > events.size() ? h - events.size() : 0;
+}
+
+namespace {
+
+size_t roundUpToPowerOfTwo(size_t n) {
+    size_t result = 1;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
+}
+
+Tracer::Tracer(size_t capacity, uint64_t sampleEvery, uint64_t minDurationNs)
+        : epoch(std::chrono::steady_clock::now()), capacity(roundUpToPowerOfTwo(capacity)),
+          sampleEvery(sampleEvery == 0 ? 1 : sampleEvery), minDurationNs(minDurationNs) {}
+
+const char *Tracer::kindName(SpanKind kind) {
+    switch (kind) {
+        case SpanKind::Decision:
+            return "decision";
+        case SpanKind::SourceSet:
+            return "sourceSet";
+        case SpanKind::Split:
+            return "split";
+        case SpanKind::BfsLevel:
+            return "bfsLevel";
+        default:
+            return "unknown";
+    }
+}
+
+bool Tracer::writeChromeTrace(const std::string &path) const {
+    FILE *f = fopen(path.c_str(), "w");
+    if (f == nullptr) {
+        return false;
+    }
+    uint64_t dropped = 0;
+    bool first = true;
+    fprintf(f, "{\"traceEvents\":[");
+    buffers.forEach([&](const TraceBuffer &buffer) {
+        dropped += buffer.dropped();
+        for (const TraceEvent &e: buffer.collect()) {
+            fprintf(f, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+                       "\"args\":{\"k\":%d,\"size\":%d,\"index\":%d,\"depth\":%d,\"outcome\":%d}}",
+                    first ? "" : ",", kindName((SpanKind) e.kind), buffer.threadId,
+                    (double) e.startNs / 1000, (double) e.durationNs / 1000,
+                    e.k, e.size, e.index, e.depth, e.outcome);
+            first = false;
+        }
+    });
+    fprintf(f, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"sampleEvery\":%llu,\"minDurationNs\":%llu,"
+               "\"dropped\":%llu}}\n",
+            (unsigned long long) sampleEvery, (unsigned long long) minDurationNs, (unsigned long long) dropped);
+    return fclose(f) == 0;
+}
@@ -0,0 +1,138 @@
+//
+// Created by agent on 10/17/26.
+//
+
+#ifndef FLIPDISTANCE_TRACER_H
+#define FLIPDISTANCE_TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "thread_slots.h"
+
+enum class SpanKind {
+    Decision, SourceSet, Split, BfsLevel, Count
+};
+
+struct TraceEvent {
+    uint64_t startNs;
+    uint64_t durationNs;
+    int32_t kind;
+    // decision parameter k, or the BFS level
+    int32_t k;
+    // subproblem size in vertices, or the BFS frontier size
+    int32_t size;
+    // source set index, -1 if not applicable
+    int32_t index;
+    int32_t depth;
+    // 1 if the span proved its decision / found the target, 0 if not, -1 if unknown
+    int32_t outcome;
+};
+
+// Ring buffer written by exactly one thread. Once full, the oldest events are overwritten.
+class TraceBuffer {
+private:
+    std::vector<TraceEvent> events;
+    const uint64_t mask;
+    std::atomic<uint64_t> head{0};
+
+public:
+    const int threadId;
+    // per kind counters for sampling, only touched by the owning thread
+    uint64_t seen[(int) SpanKind::Count]{};
+
+    TraceBuffer(size_t capacity, int threadId) : events(capacity), mask(capacity - 1), threadId(threadId) {}
+
+    void push(const TraceEvent &event) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        events[h & mask] = event;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Events still held by the buffer, oldest first.
+    std::vector<TraceEvent> collect() const;
+
+    uint64_t dropped() const;
+};
+
+// Opt-in span recorder for the search engines. Recording only touches the calling thread's buffer;
+// export with writeChromeTrace once the search has stopped.
+class Tracer {
+private:
+    const std::chrono::steady_clock::time_point epoch;
+    const size_t capacity;
+    const uint64_t sampleEvery;
+    const uint64_t minDurationNs;
+    ThreadSlots<TraceBuffer> buffers;
+
+public:
+    // capacity is rounded up to a power of two. Only every sampleEvery-th span of each kind is recorded,
+    // and recorded spans shorter than minDurationNs are discarded.
+    explicit Tracer(size_t capacity = 1 << 16, uint64_t sampleEvery = 1, uint64_t minDurationNs = 0);
+
+    TraceBuffer &local() {
+        return buffers.local([this](size_t index) { return std::make_unique<TraceBuffer>(capacity, (int) index); });
+    }
+
+    uint64_t now() const {
+        return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    bool sample(TraceBuffer &buffer, SpanKind kind) const {
+        return buffer.seen[(int) kind]++ % sampleEvery == 0;
+    }
+
+    uint64_t getMinDurationNs() const {
+        return minDurationNs;
+    }
+
+    // Chrome trace-event JSON ("X" complete events), loadable in chrome://tracing or Perfetto.
+    bool writeChromeTrace(const std::string &path) const;
+
+    static const char *kindName(SpanKind kind);
+};
+
+// Records the enclosing scope as one span. Does nothing if tracer is null or the span is not sampled.
+class TraceSpan {
+private:
+    Tracer *const tracer;
+    TraceBuffer *buffer = nullptr;
+    TraceEvent event{};
+
+public:
+    TraceSpan(Tracer *tracer, SpanKind kind, int k, int size, int depth, int index = -1) : tracer(tracer) {
+        if (tracer == nullptr) {
+            return;
+        }
+        TraceBuffer &local = tracer->local();
+        if (!tracer->sample(local, kind)) {
+            return;
+        }
+        buffer = &local;
+        event = {tracer->now(), 0, (int32_t) kind, k, size, index, depth, -1};
+    }
+
+    void setOutcome(bool outcome) {
+        event.outcome = outcome;
+    }
+
+    ~TraceSpan() {
+        if (buffer == nullptr) {
+            return;
+        }
+        event.durationNs = tracer->now() - event.startNs;
+        if (event.durationNs >= tracer->getMinDurationNs()) {
+            buffer->push(event);
+        }
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+
+    TraceSpan &operator=(const TraceSpan &) = delete;
+};
+
+#endif //FLIPDISTANCE_TRACER_H